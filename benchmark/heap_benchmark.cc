@@ -0,0 +1,201 @@
+#include "algorithms/argheap.h"
+#include "algorithms/dary_heap.h"
+#include "algorithms/mst.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+using namespace ewd;
+
+// 网格图上的Dijkstra与Prim：ArgHeap与DaryHeap的对比，以及CostBend键与64位压缩键的对比
+
+namespace
+{
+    template <typename T>
+    T infinite_key() { return numeric_limits<T>::max(); }
+
+    template <>
+    CostBend infinite_key<CostBend>() { return CostBend(numeric_limits<double>::max(), numeric_limits<int>::max(), 1e-2); }
+
+    /**
+     * @brief 把ArgHeap包装成PrimMinimumSpanningTree所需的堆接口
+     * 建堆时即含全部元素，键为无穷大；已出堆的元素由调用方以visited排除。
+     */
+    template <typename T>
+    class EagerArgHeap
+    {
+    public:
+        explicit EagerArgHeap(size_t n) : h_(vector<T>(n, infinite_key<T>())) {}
+        bool empty() const { return h_.empty(); }
+        bool contains(size_t) const { return true; }
+        T key(size_t i) const { return h_.get(i); }
+        void update(size_t i, const T &k) { h_.update(i, k); }
+        size_t pop() { return h_.pop(); }
+
+    private:
+        ArgHeap<T> h_;
+    };
+
+    CsrGraph grid_graph(size_t side, mt19937 &rng, vector<CostBend> &weights)
+    {
+        uniform_real_distribution<double> dist(1.0, 100.0);
+        Graph g;
+        g.set_vertex_num(side * side);
+        weights.clear();
+        for (size_t r = 0; r < side; r++)
+        {
+            for (size_t c = 0; c < side; c++)
+            {
+                size_t v = r * side + c;
+                if (c + 1 < side)
+                    g.add_edge(v, v + 1, dist(rng));
+                if (r + 1 < side)
+                    g.add_edge(v, v + side, dist(rng));
+            }
+        }
+        for (EdgeIndex e = 0; e < g.num_edge(); e++)
+            weights.push_back(CostBend(g.weight(e), 0, 1e-2));
+        return g.freeze();
+    }
+
+    template <typename Heap>
+    double dijkstra(const CsrGraph &g, size_t source)
+    {
+        size_t n = g.num_vertex();
+        Heap h(n);
+        vector<bool> visited(n, false);
+        vector<double> dist(n, numeric_limits<double>::max());
+        dist[source] = 0.0;
+        h.update(source, 0.0);
+        double total = 0.0;
+        while (!h.empty())
+        {
+            size_t v = h.pop();
+            visited[v] = true;
+            total += dist[v];
+            g.for_each_neighbor(v, [&](size_t i, double w)
+            {
+                size_t u = g.neighbor(i);
+                if (!visited[u] && dist[v] + w < dist[u])
+                {
+                    dist[u] = dist[v] + w;
+                    h.update(u, dist[u]);
+                }
+            });
+        }
+        return total;
+    }
+
+    struct CostBendKey
+    {
+        typedef CostBend type;
+        static CostBend of(const CostBend &cb, double) { return cb; }
+    };
+
+    struct PackedKey
+    {
+        typedef uint64_t type;
+        static uint64_t of(const CostBend &cb, double resolution) { return pack_cost_bend(cb, resolution); }
+    };
+
+    /**
+     * @brief 按(代价, 边数)字典序的Dijkstra，对比CostBend键与pack_cost_bend()的64位压缩键
+     */
+    template <typename Key>
+    double dijkstra_cost_bend(const CsrGraph &g, size_t source, double resolution)
+    {
+        size_t n = g.num_vertex();
+        DaryHeap<typename Key::type, 4> h(n);
+        vector<bool> visited(n, false);
+        vector<CostBend> label(n, infinite_key<CostBend>());
+        label[source] = CostBend(0.0, 0, 1e-2);
+        h.update(source, Key::of(label[source], resolution));
+        double total = 0.0;
+        while (!h.empty())
+        {
+            size_t v = h.pop();
+            visited[v] = true;
+            total += label[v].first;
+            g.for_each_neighbor(v, [&](size_t i, double w)
+            {
+                size_t u = g.neighbor(i);
+                CostBend cb(label[v].first + w, label[v].second + 1, 1e-2);
+                if (!visited[u] && cb < label[u])
+                {
+                    label[u] = cb;
+                    h.update(u, Key::of(cb, resolution));
+                }
+            });
+        }
+        return total;
+    }
+
+    template <typename F>
+    double best_of(size_t repeat, F f, double &result)
+    {
+        double best = numeric_limits<double>::max();
+        for (size_t i = 0; i < repeat; i++)
+        {
+            auto start = chrono::steady_clock::now();
+            result = f();
+            chrono::duration<double, milli> t = chrono::steady_clock::now() - start;
+            best = min(best, t.count());
+        }
+        return best;
+    }
+
+    template <typename Heap>
+    void run_dijkstra(const char *name, const CsrGraph &g, size_t repeat)
+    {
+        double total = 0.0;
+        double t = best_of(repeat, [&]() { return dijkstra<Heap>(g, 0); }, total);
+        printf("  dijkstra %-16s %10.3f ms  (sum of distances %.6g)\n", name, t, total);
+    }
+
+    void run_cost_bend(const CsrGraph &g, size_t repeat)
+    {
+        double total = 0.0;
+        double t = best_of(repeat, [&]() { return dijkstra_cost_bend<CostBendKey>(g, 0, 0.01); }, total);
+        printf("  costbend CostBend         %10.3f ms  (sum of distances %.6g)\n", t, total);
+        t = best_of(repeat, [&]() { return dijkstra_cost_bend<PackedKey>(g, 0, 0.01); }, total);
+        printf("  costbend packed uint64_t  %10.3f ms  (sum of distances %.6g)\n", t, total);
+    }
+
+    template <typename Heap>
+    void run_prim(const char *name, const CsrGraph &g, const vector<CostBend> &weights, size_t repeat)
+    {
+        double total = 0.0;
+        double t = best_of(repeat, [&]()
+        {
+            double w = 0.0;
+            for (size_t e : PrimMinimumSpanningTree<Heap>(g, weights, 1e-2))
+                w += weights[e].first;
+            return w;
+        }, total);
+        printf("  prim     %-16s %10.3f ms  (tree weight %.6g)\n", name, t, total);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t repeat = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5;
+    mt19937 rng(20240601);
+    for (size_t side : {100, 300, 1000})
+    {
+        vector<CostBend> weights;
+        CsrGraph g = grid_graph(side, rng, weights);
+        printf("grid %zux%zu, %zu vertices, best of %zu\n", side, side, g.num_vertex(), repeat);
+        run_dijkstra<EagerArgHeap<double>>("ArgHeap", g, repeat);
+        run_dijkstra<DaryHeap<double, 2>>("DaryHeap<2>", g, repeat);
+        run_dijkstra<DaryHeap<double, 4>>("DaryHeap<4>", g, repeat);
+        run_dijkstra<DaryHeap<double, 8>>("DaryHeap<8>", g, repeat);
+        run_cost_bend(g, repeat);
+        run_prim<EagerArgHeap<CostBend>>("ArgHeap", g, weights, repeat);
+        run_prim<DaryHeap<CostBend, 2>>("DaryHeap<2>", g, weights, repeat);
+        run_prim<DaryHeap<CostBend, 4>>("DaryHeap<4>", g, weights, repeat);
+        run_prim<DaryHeap<CostBend, 8>>("DaryHeap<8>", g, weights, repeat);
+    }
+    return 0;
+}
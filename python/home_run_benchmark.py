@@ -0,0 +1,60 @@
+from methods import *
+import glob
+import os
+import time
+
+#Home run (PSB -> JB) timing: unidirectional vs bidirectional minimum-bend search on every realworld instance
+
+def load_batch(instanceno):
+    fileloader = RevitJsonLoader(f"data/realworld/{instanceno}-ElecInfo.json")
+    configloader = ConfigLoader(f"data/realworld/{instanceno}-electricitysetting.json")
+    walls = fileloader.get_walls()
+    PSB = fileloader.get_PSB()
+    devices = fileloader.get_devices() + fileloader.get_junction_boxes()
+    doors = fileloader.get_doors()
+    configloader.substitute_circuit(fileloader.get_devices_per_room(devices))
+    circuits = sorted(configloader.get_circuits())
+
+    batch = CircuitBatch()
+    for wl in walls:
+        batch.add_wall(wl)
+    for door in doors:
+        batch.add_door(door)
+    batch.set_PSB(PSB)
+    floor_config = configloader.get_circuits_config(circuits[0])
+    floor_config.floor_height = fileloader.get_floor_height()
+    batch.read_config(floor_config)
+    for cir in circuits:
+        devices_id = configloader.get_circuit_devices(cir)
+        devices_subset = [dev for dev in devices if dev.id in devices_id]
+        batch.add_circuit(str(cir), devices_subset, configloader.get_circuits_config(cir))
+    batch.solve()
+    return batch
+
+def time_home_run(gc, bidirectional, repeat):
+    da = DecompositionApproach(gc.g)
+    da.PSB = gc.PSB_index
+    da.devices = vecIndex([gc.JB_index])
+    da.bidirectional = bidirectional
+    start = time.perf_counter()
+    for _ in range(repeat):
+        da.solve(False)
+    return (time.perf_counter() - start) / repeat, da.obj
+
+if __name__ == '__main__':
+    repeat = 20
+    instances = sorted(int(os.path.basename(f).split('-')[0]) for f in glob.glob("data/realworld/*-ElecInfo.json"))
+    total_uni, total_bi = 0.0, 0.0
+    for instanceno in instances:
+        batch = load_batch(instanceno)
+        for result in batch.results:
+            t_uni, obj_uni = time_home_run(result.gc, False, repeat)
+            t_bi, obj_bi = time_home_run(result.gc, True, repeat)
+            total_uni += t_uni
+            total_bi += t_bi
+            same = abs(obj_uni.first - obj_bi.first) <= 1e-2 and obj_uni.second == obj_bi.second
+            print(f'instance {instanceno}, circuit {result.id}, '
+                  f'unidirectional {t_uni * 1e3 :.3f} ms, bidirectional {t_bi * 1e3 :.3f} ms, '
+                  f'cost = {obj_bi.first :.2f}, bend = {obj_bi.second}' + ('' if same else
+                  f', MISMATCH (unidirectional cost = {obj_uni.first :.2f}, bend = {obj_uni.second})'))
+    print(f'total: unidirectional {total_uni * 1e3 :.3f} ms, bidirectional {total_bi * 1e3 :.3f} ms')
@@ -6,7 +6,6 @@ from excel_export import *
 import plotly.graph_objects as go
 import plotly.colors as pc
 
-from EWDpy import vecIndex
 import cadquery as cq
 from cadquery.occ_impl.exporters.assembly import exportAssembly
 
@@ -65,66 +64,56 @@ if __name__ == '__main__':
     if export_excel:
         all_lengths = {}
 
-    for idx, cir in enumerate(circuits):
+    #Walls, doors and PSB are shared by all circuits: preprocess them once in C++
+    batch = CircuitBatch()
+    for wl in walls:
+        batch.add_wall(wl)
+    for door in doors:
+        batch.add_door(door)
+    batch.set_PSB(PSB)
+    floor_config = configloader.get_circuits_config(circuits[0])
+    floor_config.floor_height = fileloader.get_floor_height()
+    batch.read_config(floor_config)
+
+    devices_subsets = []
+    for cir in circuits:
 
         #List of devices id in the current circuit
         devices_id = configloader.get_circuit_devices(cir)
         
         #Config object like costs, thresholds, wire unit cost.
         config = configloader.get_circuits_config(cir)
-        
-        #Set floor height
-        config.floor_height = fileloader.get_floor_height()
 
         #List of devices object from that list of ids
         devices_subset = [dev for dev in devices if dev.id in devices_id]
-        
-        #Create constructor
-        gc = GraphConstructor()
-        
-        
-        for wl in walls:
-            gc.add_wall(wl)
-        gc.set_PSB(PSB)
-        for door in doors:
-            gc.add_door(door)
-        for dev in devices_subset:
-            gc.add_device(dev)
-        gc.read_config(config)
-        gc.construct()
-    
-        #Create Room Harness
-        da = DecompositionApproach(gc.g) 
-        da.PSB = gc.JB_index
-        da.devices = gc.devices_indices
-        da.solve(use_mst = False)
-        
-        #Create Home Run Wires
-        da.PSB = gc.PSB_index 
-        da.devices = vecIndex()  # Create an empty C++ vector
-        da.devices.append(gc.JB_index)  # Add the JB_index as the only element
-        da.solve(use_mst = False)
+        devices_subsets.append(devices_subset)
+        batch.add_circuit(str(cir), devices_subset, config)
 
-        
+    #Build every circuit's graph, then solve room harness (JB -> devices) and home run (PSB -> JB) in parallel
+    batch.solve()
 
+    for idx, cir in enumerate(circuits):
+        result = batch.results[idx]
+        gc = result.gc
+        devices_subset = devices_subsets[idx]
 
         #Routine Done, Gather important info
         if export_excel:
-            lengths = paths_to_lengths(gc,cir,da.paths)
+            lengths = paths_to_lengths(gc,cir,result.paths)
             all_lengths.update(lengths)
             
         if show_p_final:
-            fig_add_paths(fig, gc, da.paths, circuit_colors[idx % num_colors])
+            fig_add_paths(fig, gc, result.paths, circuit_colors[idx % num_colors])
         #plotly_show(fig, x_center,y_center,z_center, max_range)
         
         if export_cad:
-            wires = add_paths(wires,gc,da.paths)
+            wires = add_paths(wires,gc,result.paths)
             
         
         if show_p_grid:
             plot_3d_network(gc, x_center,y_center,z_center,max_range)
 
-        print(f'instance {instanceno}, circuit {cir}, devices = {len(devices_subset)+1}, cost = {da.obj.first :.2f}, bend = {da.obj.second}')
+        print(f'instance {instanceno}, circuit {cir}, devices = {len(devices_subset)+1}, cost = {result.home_run_obj.first :.2f}, bend = {result.home_run_obj.second}')
         
 
     #Export excel
@@ -8,6 +8,30 @@ if __name__ == '__main__':
     da.devices = vecIndex(devices[1:])
     da.solve()
     print(f'instance {path}, cost = {da.obj.first :.2f}, bend = {da.obj.second}')
+
+    # Optimality gap of the heuristics against the exact Steiner tree (Dreyfus-Wagner)
+    heuristics = {'terminal mst': RoutingMode_TERMINAL_MST,
+                  'mehlhorn': RoutingMode_MEHLHORN,
+                  'tree growing': RoutingMode_TREE_GROWING}
+    exact = DecompositionApproach(g)
+    exact.PSB = devices[0]
+    exact.devices = vecIndex(devices[1:])
+    exact.solve(RoutingMode_EXACT_STEINER)
+    if exact.exact_solved:
+        print(f'exact steiner, cost = {exact.obj.first :.2f}, bend = {exact.obj.second}')
+    else:
+        # Too many devices or too little memory: the solver fell back to tree growing
+        print('exact steiner not solved (fell back to tree growing), gaps skipped')
+    for name, mode in heuristics.items():
+        h = DecompositionApproach(g)
+        h.PSB = devices[0]
+        h.devices = vecIndex(devices[1:])
+        h.solve(mode)
+        line = f'{name}, cost = {h.obj.first :.2f}, bend = {h.obj.second}'
+        if exact.exact_solved:
+            gap = (h.obj.first - exact.obj.first) / exact.obj.first * 100
+            line += f', gap = {gap :.2f}%'
+        print(line)
     
     # # Gurobi
     # from gurobi_solve import grb_solve
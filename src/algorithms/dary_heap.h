@@ -0,0 +1,138 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <limits>
+
+namespace ewd
+{
+    /**
+     * @brief d叉索引堆
+     * 元素编号为[0, n)，首次发现时才插入，只占用实际到达的元素；
+     * 键与编号连续存放在同一数组中，上浮、下沉均为迭代。
+     *
+     * @tparam T 键类型
+     * @tparam D 叉数
+     * @tparam Less 键的比较，Less()(a, b)为真时a先出堆
+     */
+    template <typename T, size_t D = 4, typename Less = std::less<T>>
+    class DaryHeap
+    {
+        static_assert(D >= 2, "DaryHeap needs at least two children per node");
+
+    public:
+        static const size_t NPOS = std::numeric_limits<size_t>::max();
+
+        explicit DaryHeap(size_t n = 0, const Less &less = Less()) : pos_(n, NPOS), less_(less) {}
+
+        /**
+         * @brief 清空堆，元素数变化时重新分配
+         */
+        void reset(size_t n)
+        {
+            for (const Node &nd : heap_)
+                pos_[nd.id] = NPOS;
+            heap_.clear();
+            if (pos_.size() != n)
+                pos_.assign(n, NPOS);
+        }
+
+        size_t size() const { return heap_.size(); }
+        bool empty() const { return heap_.empty(); }
+        bool contains(size_t i) const { return pos_[i] != NPOS; }
+        size_t top() const { return heap_[0].id; }
+        const T &top_key() const { return heap_[0].key; }
+        const T &key(size_t i) const { return heap_[pos_[i]].key; } // 须contains(i)
+
+        /**
+         * @brief 不在堆中时插入，否则修改键
+         */
+        void update(size_t i, const T &k)
+        {
+            size_t p = pos_[i];
+            if (p == NPOS)
+            {
+                heap_.push_back(Node{k, i});
+                sift_up(heap_.size() - 1);
+            }
+            else if (less_(k, heap_[p].key))
+            {
+                heap_[p].key = k;
+                sift_up(p);
+            }
+            else
+            {
+                heap_[p].key = k;
+                sift_down(p);
+            }
+        }
+
+        size_t pop()
+        {
+            size_t ret = heap_[0].id;
+            pos_[ret] = NPOS;
+            Node last = heap_.back();
+            heap_.pop_back();
+            if (!heap_.empty())
+            {
+                heap_[0] = last;
+                sift_down(0);
+            }
+            return ret;
+        }
+
+    private:
+        struct Node
+        {
+            T key;
+            size_t id;
+        };
+        std::vector<Node> heap_;
+        std::vector<size_t> pos_; // 元素在堆中的位置，不在堆中时为NPOS
+        Less less_;
+
+        void sift_up(size_t i)
+        {
+            Node nd = heap_[i];
+            while (i > 0)
+            {
+                size_t parent = (i - 1) / D;
+                if (!less_(nd.key, heap_[parent].key))
+                    break;
+                heap_[i] = heap_[parent];
+                pos_[heap_[i].id] = i;
+                i = parent;
+            }
+            heap_[i] = nd;
+            pos_[nd.id] = i;
+        }
+
+        void sift_down(size_t i)
+        {
+            Node nd = heap_[i];
+            size_t n = heap_.size();
+            while (true)
+            {
+                size_t first = D * i + 1;
+                if (first >= n)
+                    break;
+                size_t last = first + D < n ? first + D : n;
+                size_t best = first;
+                for (size_t c = first + 1; c < last; c++)
+                {
+                    if (less_(heap_[c].key, heap_[best].key))
+                        best = c;
+                }
+                if (!less_(heap_[best].key, nd.key))
+                    break;
+                heap_[i] = heap_[best];
+                pos_[heap_[i].id] = i;
+                i = best;
+            }
+            heap_[i] = nd;
+            pos_[nd.id] = i;
+        }
+    };
+
+    template <typename T, size_t D, typename Less>
+    const size_t DaryHeap<T, D, Less>::NPOS;
+}
@@ -1,79 +1,233 @@
 #include "algorithms/mbsp.h"
-#include "algorithms/argheap.h"
-#include <queue>
+#include <cmath>
+#include <algorithm>
 #include <tuple>
 
 using namespace std;
 
 namespace ewd
 {
-    void MinBendShortestPath::reset()
+    const uint32_t PathTree::NONE;
+
+    void MbspWorkspace::prepare(size_t num_vertex, size_t num_state, const CostBend& init, double key_resolution)
     {
-        root_=g_.num_vertex();
-        predecessors_.assign(g_.num_vertex(),vector<size_t>());
-        cb_.assign(g_.num_vertex(),CostBend(numeric_limits<double>::infinity(),numeric_limits<int>::infinity()));
+        init_ = init;
+        key_resolution_ = key_resolution;
+        if (stamp_.size() != num_vertex)
+        {
+            stamp_.assign(num_vertex, 0);
+            label.assign(num_vertex, init);
+            preds.assign(num_vertex, vecIndex());
+            pred_direcs.assign(num_vertex, vector<EdgeDirection>());
+            settled.assign(num_vertex, 0);
+            target.assign(num_vertex, 0);
+            best_state.assign(num_vertex, numeric_limits<size_t>::max());
+            source.assign(num_vertex, numeric_limits<size_t>::max());
+        }
+        if (state_stamp_.size() != num_state)
+        {
+            state_stamp_.assign(num_state, 0);
+            state_label.assign(num_state, init);
+            state_pred.assign(num_state, numeric_limits<size_t>::max());
+            state_source.assign(num_state, numeric_limits<size_t>::max());
+            state_settled.assign(num_state, 0);
+        }
+        if (packed())
+            packed_heap_.reset(num_vertex);
+        else
+            heap_.reset(num_vertex);
+        state_heap.clear();
+        touched_.clear();
+        touched_states_.clear();
+        if (++generation_ == 0)
+        {
+            // 代数回绕，清空所有标记
+            fill(stamp_.begin(), stamp_.end(), 0);
+            fill(state_stamp_.begin(), state_stamp_.end(), 0);
+            generation_ = 1;
+        }
+    }
+
+    // 每个顶点的状态数：GENERAL及之前的七个进入方向，外加起点的无方向状态
+    static const size_t NUM_STATE = GENERAL + 2;
+    static const size_t NO_DIREC = GENERAL + 1;
+
+    // 状态堆的比较：代价小的先出堆
+    static bool state_later(const pair<CostBend, size_t> &a, const pair<CostBend, size_t> &b)
+    {
+        return b.first < a.first;
     }
 
     size_t MinBendShortestPath::get_predecessor_num(size_t v) const
     {
-        if(v>=predecessors_.size()) return 0;
-        return predecessors_[v].size();
+        if(!ws_.touched(v)) return 0;
+        return ws_.preds[v].size();
     }
 
     size_t MinBendShortestPath::predecessor(size_t v, size_t n_direc) const
     {
-        if(v>=predecessors_.size()) return numeric_limits<size_t>::infinity();
-        if(n_direc >= predecessors_[v].size()) return numeric_limits<size_t>::infinity();
-        return predecessors_[v][n_direc];
+        if(!ws_.touched(v)) return numeric_limits<size_t>::infinity();
+        if(n_direc >= ws_.preds[v].size()) return numeric_limits<size_t>::infinity();
+        return ws_.preds[v][n_direc];
     }
 
     double MinBendShortestPath::distance(size_t v) const
     {
-        if(v>=cb_.size()) return numeric_limits<double>::infinity();
-        return cb_[v].first;
+        if(!ws_.touched(v)) return numeric_limits<double>::infinity();
+        return ws_.label[v].first;
     }
 
     int MinBendShortestPath::num_bend(size_t v) const 
     {
-        if(v>=cb_.size()) return numeric_limits<int>::infinity();
-        return cb_[v].second;
+        if(!ws_.touched(v)) return numeric_limits<int>::max();
+        return ws_.label[v].second;
     }
 
-    bool MinBendShortestPath::get_path(size_t v, vecIndex& pathvec, size_t n_direc) const
+    /**
+     * @brief 沿前继列表回溯路径，有多个前继时优先选择与路径后续同向的前继
+     *
+     * @param num_pred num_pred(u)：u的前继数
+     * @param pred pred(u, k)：u的第k个前继
+     * @param direc direc(u, k)：u的第k个前继指向u的方向
+     */
+    template <typename NumPred, typename Pred, typename Direc>
+    static bool trace_predecessors(const SpatialGraph& g, size_t v, size_t n_direc,
+                                   NumPred num_pred, Pred pred, Direc direc, vecIndex& pathvec)
     {
         pathvec.clear();
-        if (predecessors_.size() <= v) return false;
-        if (predecessors_[v].size() == 0) return false;
-
-        if(n_direc >= predecessors_[v].size()) n_direc = 0;
+        if (num_pred(v) == 0) return false;
+        if(n_direc >= num_pred(v)) n_direc = 0;
 
-        double REL_ERR = g_.REL_ERR();
-        double WEAK_PARA_ERR = g_.WEAK_PARALLEL_ERR();
-        size_t q = predecessors_[v][n_direc];
+        double REL_ERR = g.REL_ERR();
+        double WEAK_PARA_ERR = g.WEAK_PARALLEL_ERR();
+        size_t q = pred(v, n_direc);
         pathvec.push_back(v);
         pathvec.push_back(q);
-        size_t u = q;
-        Point d = (g_.vertex(v)-g_.vertex(q)).normalized();
-        while (predecessors_[u].size() > 0)
+        size_t u = q, w = v;   // 当前顶点及路径上的后继
+        EdgeDirection dc = direc(v, n_direc); // u指向w的方向
+        // u的第k个前继是否与u到w同向
+        auto along = [&](size_t k)
+        {
+            EdgeDirection dk = direc(u, k);
+            if(dc != GENERAL && dk != GENERAL)
+                return same_axis(dc, dk);
+            Point d = (g.vertex(w)-g.vertex(u)).normalized();
+            return d.IsWeakParallel(g.vertex(u)-g.vertex(pred(u, k)),REL_ERR,WEAK_PARA_ERR);
+        };
+        while (num_pred(u) > 0)
         {
             size_t itr = 0; // 同向前继的序号
-            Point up = g_.vertex(u);
-            for(size_t itr2 = 1; itr2 < predecessors_[u].size();itr2++)
+            for(size_t itr2 = 1; itr2 < num_pred(u);itr2++)
             {
-                Point q1 = g_.vertex(predecessors_[u][itr]);
-                Point q2 = g_.vertex(predecessors_[u][itr2]);
-                if((!d.IsWeakParallel(up-q1,REL_ERR,WEAK_PARA_ERR))&&
-                    d.IsWeakParallel(up-q2,REL_ERR,WEAK_PARA_ERR))
+                if(!along(itr) && along(itr2))
                     itr = itr2;
             }
-            u = predecessors_[u][itr];
-            d = (up - g_.vertex(u)).normalized();
+            dc = direc(u, itr);
+            w = u;
+            u = pred(u, itr);
             pathvec.push_back(u);
         }
         reverse(pathvec.begin(), pathvec.end());
         return true;
     }
 
+    bool MinBendShortestPath::get_path(size_t v, vecIndex& pathvec, size_t n_direc) const
+    {
+        pathvec.clear();
+        if (get_predecessor_num(v) == 0) return false;
+
+        if(mode == BendMode::DIRECTION_STATES)
+        {
+            // 状态的前继唯一，直接回溯
+            for(size_t s = ws_.best_state[v]; s != numeric_limits<size_t>::max(); s = ws_.state_pred[s])
+                pathvec.push_back(s / NUM_STATE);
+            reverse(pathvec.begin(), pathvec.end());
+            return true;
+        }
+
+        return trace_predecessors(g_, v, n_direc,
+            [&](size_t u) { return get_predecessor_num(u); },
+            [&](size_t u, size_t k) { return ws_.preds[u][k]; },
+            [&](size_t u, size_t k) { return ws_.pred_direcs[u][k]; },
+            pathvec);
+    }
+
+    bool MinBendShortestPath::get_path(const PathTree& tree, size_t v, vecIndex& pathvec, size_t n_direc) const
+    {
+        pathvec.clear();
+        if(tree.empty()) return false;
+
+        size_t iv = tree.vertex_index(v);
+        if(iv == PathTree::NONE) return false;
+        if(tree.mode == BendMode::DIRECTION_STATES)
+        {
+            size_t s = tree.best_state[iv];
+            if(tree.state_index(s) == PathTree::NONE) return false;
+            // 起点的状态没有前继，不在states中
+            for(size_t i = tree.state_index(s); ; i = tree.state_index(s))
+            {
+                pathvec.push_back(s / NUM_STATE);
+                if(i == PathTree::NONE) break;
+                s = tree.preds[i];
+            }
+            reverse(pathvec.begin(), pathvec.end());
+            return true;
+        }
+
+        // 路径上的顶点均已确定，前继位置在回溯时逐个二分查找
+        return trace_predecessors(g_, v, n_direc,
+            [&](size_t u) { size_t i = tree.vertex_index(u); return i == PathTree::NONE ? size_t(0) : size_t(tree.offsets[i + 1] - tree.offsets[i]); },
+            [&](size_t u, size_t k) { return size_t(tree.preds[tree.offsets[tree.vertex_index(u)] + k]); },
+            [&](size_t u, size_t k) { return tree.direcs[tree.offsets[tree.vertex_index(u)] + k]; },
+            pathvec);
+    }
+
+    PathTree MinBendShortestPath::export_tree() const
+    {
+        PathTree tree;
+        size_t n = ws_.num_vertex();
+        if(root_ >= n || n * NUM_STATE >= PathTree::NONE)
+            return tree;
+        tree.root = root_;
+        tree.mode = mode;
+        // 只保留已确定的顶点和状态，只扫描本次求解访问过的部分
+        for(size_t v : ws_.touched_vertices())
+        {
+            if(ws_.settled[v])
+                tree.vertices.push_back(uint32_t(v));
+        }
+        sort(tree.vertices.begin(), tree.vertices.end());
+        if(mode == BendMode::DIRECTION_STATES)
+        {
+            for(size_t s : ws_.touched_states())
+            {
+                if(ws_.state_settled[s] && ws_.state_pred[s] != numeric_limits<size_t>::max())
+                    tree.states.push_back(uint32_t(s));
+            }
+            sort(tree.states.begin(), tree.states.end());
+            tree.preds.reserve(tree.states.size());
+            for(uint32_t s : tree.states)
+                tree.preds.push_back(uint32_t(ws_.state_pred[s]));
+            tree.best_state.reserve(tree.vertices.size());
+            for(uint32_t v : tree.vertices)
+                tree.best_state.push_back(uint32_t(ws_.best_state[v]));
+            return tree;
+        }
+
+        tree.offsets.reserve(tree.vertices.size() + 1);
+        tree.offsets.push_back(0);
+        for(uint32_t v : tree.vertices)
+        {
+            for(size_t k = 0; k < ws_.preds[v].size(); k++)
+            {
+                tree.preds.push_back(uint32_t(ws_.preds[v][k]));
+                tree.direcs.push_back(ws_.pred_direcs[v][k]);
+            }
+            tree.offsets.push_back(uint32_t(tree.preds.size()));
+        }
+        return tree;
+    }
+
     vecIndex MinBendShortestPath::get_path(size_t v, size_t n_direc) const
     {
         vecIndex out;
@@ -81,68 +235,531 @@ namespace ewd
         return out;
     }
 
+    void MinBendShortestPath::freeze()
+    {
+        if(csr_ == nullptr || csr_version_ != g_.version())
+        {
+            csr_ = make_shared<const CsrGraph>(g_.freeze());
+            csr_version_ = g_.version();
+
+            // 任一路径的代价不小于unit_cost_乘路径长度，全部沿轴时路径长度不小于曼哈顿距离
+            const CsrGraph& csr = *csr_;
+            unit_cost_ = numeric_limits<double>::infinity();
+            axis_only_ = true;
+            for(size_t v = 0; v < csr.num_vertex(); v++)
+            {
+                for(size_t i = csr.begin(v); i < csr.end(v); i++)
+                {
+                    Point d = g_.vertex(csr.neighbor(i)) - g_.vertex(v);
+                    double len = d.norm();
+                    axis_only_ = axis_only_ && csr.direction(i) != GENERAL;
+                    if(len > 0.0)
+                        unit_cost_ = min(unit_cost_, csr.weight(i) / len);
+                }
+            }
+            if(!(unit_cost_ < numeric_limits<double>::infinity()) || unit_cost_ < 0.0)
+                unit_cost_ = 0.0;
+        }
+    }
+
+    double MinBendShortestPath::lower_bound(const Point& p, size_t v) const
+    {
+        Point d = g_.vertex(v) - p;
+        double len = axis_only_ ? fabs(d.x) + fabs(d.y) + fabs(d.z) : d.norm();
+        return unit_cost_ * len;
+    }
+
+    CostBend MinBendShortestPath::heap_key(const MbspWorkspace& ws, size_t v, const CostBend& cb) const
+    {
+        if(astar_target_ == numeric_limits<size_t>::max())
+            return cb;
+        double h = lower_bound(astar_point_, v);
+        if(astar_source_ != numeric_limits<size_t>::max())
+        {
+            // 双向求解取两侧下界之差的一半，两侧的约化边权相同且非负
+            h = (h - lower_bound(astar_source_point_, v)) / 2;
+            if(&ws == &back_ws_)
+                h = -h;
+        }
+        return CostBend(cb.first + h, cb.second, cb.err);
+    }
+
     void MinBendShortestPath::solve(size_t root, size_t expected_end)
     {
-        reset();
+        if(expected_end < g_.num_vertex())
+            solve(root, vecIndex{expected_end});
+        else
+            solve(root, vecIndex());
+    }
+
+    void MinBendShortestPath::solve(size_t root, const vecIndex& targets)
+    {
+        run(vecIndex{root}, targets);
         root_ = root;
+    }
+
+    void MinBendShortestPath::solve_multi_source(const vecIndex& roots, const vecIndex& targets)
+    {
+        run(roots, targets);
+    }
+
+    size_t MinBendShortestPath::source(size_t v) const
+    {
+        if(!ws_.touched(v)) return numeric_limits<size_t>::max();
+        return ws_.source[v];
+    }
+
+    int MinBendShortestPath::num_bend_through(size_t u, size_t v) const
+    {
+        if(!ws_.touched(u) || !ws_.touched(v) || !(ws_.label[u].first < numeric_limits<double>::infinity()) ||
+           !(ws_.label[v].first < numeric_limits<double>::infinity()))
+            return numeric_limits<int>::max();
+        return joint_bends(ws_, u, ws_, v, direction_code(g_.vertex(v) - g_.vertex(u), g_.REL_ERR()));
+    }
+
+    vecIndex MinBendShortestPath::path_through(size_t u, size_t v) const
+    {
+        vecIndex path, back;
+        if(num_bend_through(u, v) == numeric_limits<int>::max())
+            return path;
+        // 两端优先选择与边共线的前继，与num_bend_through()的计数一致
+        EdgeDirection duv = direction_code(g_.vertex(v) - g_.vertex(u), g_.REL_ERR());
+        auto along = [&](size_t x, size_t other, EdgeDirection dc)
+        {
+            if(mode == BendMode::DIRECTION_STATES)
+                return size_t(0);
+            size_t k = straight_pred(ws_, x, other, dc);
+            return k == numeric_limits<size_t>::max() ? size_t(0) : k;
+        };
+        if(!get_path(u, path, along(u, v, duv)))
+            path.assign(1, u);
+        if(!get_path(v, back, along(v, u, reversed(duv))))
+            back.assign(1, v);
+        path.insert(path.end(), back.rbegin(), back.rend());
+        return path;
+    }
+
+    int MinBendShortestPath::joint_bends(const MbspWorkspace& a, size_t x, const MbspWorkspace& b, size_t y, EdgeDirection dc) const
+    {
+        // 两侧各自沿边延伸，与前继共线时不计弯折
+        auto straight = [&](const MbspWorkspace& ws, size_t v, size_t u, EdgeDirection d)
+        {
+            if(mode == BendMode::DIRECTION_STATES)
+            {
+                size_t din = ws.best_state[v] % NUM_STATE;
+                return ws.best_state[v] != numeric_limits<size_t>::max() && din != NO_DIREC && same_axis(EdgeDirection(din), d);
+            }
+            return straight_pred(ws, v, u, d) != numeric_limits<size_t>::max();
+        };
+        int bends = a.label[x].second + b.label[y].second + 2;
+        if(straight(a, x, y, dc))
+            bends--;
+        if(straight(b, y, x, reversed(dc)))
+            bends--;
+        return bends;
+    }
+
+    void MinBendShortestPath::solve_bidirectional(size_t root, size_t target)
+    {
         size_t n = g_.num_vertex();
-        vector<bool> visited(n,false);
-        double REL_ERR = g_.REL_ERR();
+        if(mode == BendMode::DIRECTION_STATES || root >= n || target >= n || root == target)
+        {
+            solve(root, target);
+            return;
+        }
+        start(false);
         double ABS_ERR = g_.REL_ERR();
-        double WEAK_PARA_ERR = g_.WEAK_PARALLEL_ERR();
         using CB = ewd::CostBend;
-        const CB MAX_CB(numeric_limits<double>::infinity(), numeric_limits<int>::max(), ABS_ERR);
-        for(auto& cb:cb_) cb.err = ABS_ERR;
+        const CsrGraph& csr = *csr_;
+        const CB INF_CB(numeric_limits<double>::infinity(), numeric_limits<int>::max(), ABS_ERR);
+        back_ws_.prepare(n, 0, INF_CB, key_resolution);
+        if(use_astar && unit_cost_ > 0.0)
+        {
+            astar_target_ = target;
+            astar_point_ = g_.vertex(target);
+            astar_source_ = root;
+            astar_source_point_ = g_.vertex(root);
+        }
+        add_roots(vecIndex{root});
+        back_ws_.touch(target);
+        back_ws_.label[target] = CB(0.0,-1,ABS_ERR);
+        back_ws_.source[target] = target;
+        back_ws_.heap_update(target, heap_key(back_ws_, target, back_ws_.label[target]));
 
-        ArgHeap<CB> h(vector<CB>(n, MAX_CB));
-        size_t v;
-        Point d;
+        // 最优路径经过边(meet_x, meet_y)，正向到meet_x，反向到meet_y
+        CB best = INF_CB;
+        size_t meet_x = numeric_limits<size_t>::max(), meet_y = numeric_limits<size_t>::max();
+        while(!ws_.heap_empty() && !back_ws_.heap_empty())
+        {
+            // 更短或等长的路径至少有一条边两端分别在两侧确定，此时已被检查过；
+            // 两侧的下界在路径上相互抵消，键之和与代价直接比较
+            double top_f = ws_.heap_top_key().first, top_b = back_ws_.heap_top_key().first;
+            if(top_f + top_b > best.first + best.err)
+                break;
+            bool forward = top_f <= top_b;
+            MbspWorkspace& a = forward ? ws_ : back_ws_;
+            const MbspWorkspace& b = forward ? back_ws_ : ws_;
+            size_t x = a.heap_pop();
+            a.settled[x] = 1;
+            csr.for_each_neighbor(x, [&](size_t i, double w)
+            {
+                size_t y = csr.neighbor(i);
+                if(!b.touched(y) || !b.settled[y]) return;
+                CB cb(a.label[x].first + w + b.label[y].first, joint_bends(a, x, b, y, csr.direction(i)), ABS_ERR);
+                if(cb < best)
+                {
+                    best = cb;
+                    meet_x = forward ? x : y;
+                    meet_y = forward ? y : x;
+                }
+            });
+            expand_lists(a, x);
+        }
+        if(meet_x == numeric_limits<size_t>::max())
+            return;
 
-        h.update(root, CB(0.0,-1,ABS_ERR));
+        // 两侧在相接处优先选择与相接边共线的前继
+        EdgeDirection dxy = direction_code(g_.vertex(meet_y) - g_.vertex(meet_x), g_.REL_ERR());
+        auto along = [&](const MbspWorkspace& ws, size_t u, size_t other, EdgeDirection dc)
+        {
+            size_t k = straight_pred(ws, u, other, dc);
+            return k == numeric_limits<size_t>::max() ? size_t(0) : k;
+        };
+        vecIndex fpath, bpath;
+        if(!get_path(meet_x, fpath, along(ws_, meet_x, meet_y, dxy)))
+            fpath.assign(1, meet_x);
+        if(!trace_predecessors(g_, meet_y, along(back_ws_, meet_y, meet_x, reversed(dxy)),
+            [&](size_t u) { return back_ws_.touched(u) ? back_ws_.preds[u].size() : size_t(0); },
+            [&](size_t u, size_t k) { return back_ws_.preds[u][k]; },
+            [&](size_t u, size_t k) { return back_ws_.pred_direcs[u][k]; },
+            bpath))
+            bpath.assign(1, meet_y);
+        // 去掉路径上的环（零长度的边可能造成）
+        vecIndex path;
+        auto append = [&](size_t u)
+        {
+            auto it = find(path.begin(), path.end(), u);
+            if(it != path.end())
+                path.erase(it + 1, path.end());
+            else
+                path.push_back(u);
+        };
+        for(size_t u : fpath)
+            append(u);
+        for(auto it = bpath.rbegin(); it != bpath.rend(); it++)
+            append(*it);
 
-        while (h.size() > 0)
+        // 结果写入正向一侧，target沿路径回溯到root
+        for(size_t i = 0; i < path.size(); i++)
         {
-            v = h.pop();
-            visited[v] = true;
-            cb_[v] = h.get(v);
-            if (v == expected_end)
-                break;
-            if (h.get(v) == MAX_CB)
-                break;
-            if ( (expected_end < n) && h.get(expected_end)<h.get(v))
-                continue;
-            for(auto nb : g_.reachable_neighbors(v))
+            size_t u = path[i];
+            ws_.touch(u);
+            ws_.settled[u] = 1;
+            ws_.source[u] = root;
+            ws_.preds[u].clear();
+            ws_.pred_direcs[u].clear();
+            if(i > 0)
+            {
+                ws_.preds[u].push_back(path[i - 1]);
+                ws_.pred_direcs[u].push_back(direction_code(g_.vertex(u) - g_.vertex(path[i - 1]), g_.REL_ERR()));
+            }
+        }
+        ws_.label[target] = best;
+    }
+
+    size_t MinBendShortestPath::solve_nearest(const vecIndex& roots, const vecIndex& targets)
+    {
+        start(true);
+        mark_targets(targets);
+        add_roots(roots);
+        pending_ = search(vecIndex(), 0);
+        return pending_;
+    }
+
+    size_t MinBendShortestPath::grow_sources(const vecIndex& roots)
+    {
+        if(!incremental_) return numeric_limits<size_t>::max();
+        // 上次停止时出堆的目标尚未扩展，放回堆中
+        if(pending_ != numeric_limits<size_t>::max())
+        {
+            size_t v = pending_;
+            if(mode == BendMode::DIRECTION_STATES)
+            {
+                size_t s = ws_.best_state[v];
+                ws_.state_settled[s] = 0;
+                ws_.state_heap.push_back(make_pair(ws_.state_label[s], s));
+                push_heap(ws_.state_heap.begin(), ws_.state_heap.end(), state_later);
+            }
+            else
+            {
+                ws_.settled[v] = 0;
+                ws_.heap_update(v, heap_key(ws_, v, ws_.label[v]));
+            }
+        }
+        add_roots(roots);
+        pending_ = search(vecIndex(), 0);
+        return pending_;
+    }
+
+    void MinBendShortestPath::run(const vecIndex& roots, const vecIndex& targets)
+    {
+        start(false);
+        // 单起点、单目标的点对点求解按A*进行；弯折数不计入下界，只在代价相近时比较，顺序不受影响
+        if(use_astar && roots.size() == 1 && targets.size() == 1 && targets[0] < g_.num_vertex() && unit_cost_ > 0.0)
+        {
+            astar_target_ = targets[0];
+            astar_point_ = g_.vertex(astar_target_);
+        }
+        size_t num_left = mark_targets(targets);
+        add_roots(roots);
+        search(targets, num_left);
+    }
+
+    void MinBendShortestPath::start(bool incremental)
+    {
+        freeze();
+        root_ = numeric_limits<size_t>::max();
+        astar_target_ = numeric_limits<size_t>::max();
+        astar_source_ = numeric_limits<size_t>::max();
+        incremental_ = incremental;
+        pending_ = numeric_limits<size_t>::max();
+        size_t n = g_.num_vertex();
+        double ABS_ERR = g_.REL_ERR();
+        using CB = ewd::CostBend;
+        // 未到达的顶点、状态的代价
+        const CB INF_CB(numeric_limits<double>::infinity(), numeric_limits<int>::max(), ABS_ERR);
+        ws_.prepare(n, mode == BendMode::DIRECTION_STATES ? n * NUM_STATE : 0, INF_CB, key_resolution);
+    }
+
+    size_t MinBendShortestPath::mark_targets(const vecIndex& targets)
+    {
+        size_t n = g_.num_vertex();
+        size_t num_left = 0;
+        for(size_t t : targets)
+        {
+            if(t < n)
+            {
+                ws_.touch(t);
+                num_left += !ws_.target[t];
+                ws_.target[t] = 1;
+            }
+        }
+        return num_left;
+    }
+
+    void MinBendShortestPath::add_roots(const vecIndex& roots)
+    {
+        size_t n = g_.num_vertex();
+        double ABS_ERR = g_.REL_ERR();
+        const CostBend ROOT_CB(0.0,-1,ABS_ERR);
+        for(size_t root : roots)
+        {
+            if(root >= n) continue;
+            ws_.touch(root);
+            if(mode == BendMode::DIRECTION_STATES)
+            {
+                size_t s0 = root * NUM_STATE + NO_DIREC;
+                ws_.touch_state(s0);
+                if(!(ROOT_CB < ws_.state_label[s0])) continue;
+                ws_.state_label[s0] = ROOT_CB;
+                ws_.state_pred[s0] = numeric_limits<size_t>::max();
+                ws_.state_source[s0] = root;
+                ws_.state_settled[s0] = 0;
+                ws_.state_heap.push_back(make_pair(heap_key(ws_, root, ROOT_CB), s0));
+                push_heap(ws_.state_heap.begin(), ws_.state_heap.end(), state_later);
+            }
+            else
+            {
+                if(!(ROOT_CB < ws_.label[root])) continue;
+                ws_.label[root] = ROOT_CB;
+                ws_.preds[root].clear();
+                ws_.pred_direcs[root].clear();
+                ws_.source[root] = root;
+                ws_.settled[root] = 0;
+                ws_.heap_update(root, heap_key(ws_, root, ROOT_CB));
+            }
+        }
+    }
+
+    size_t MinBendShortestPath::search(const vecIndex& targets, size_t num_left)
+    {
+        if(mode == BendMode::DIRECTION_STATES)
+            return solve_states(num_left);
+        return solve_lists(targets, num_left);
+    }
+
+    size_t MinBendShortestPath::straight_pred(const MbspWorkspace& ws, size_t v, size_t u, EdgeDirection dc) const
+    {
+        const vecIndex& preds_v = ws.preds[v];
+        const vector<EdgeDirection>& direcs_v = ws.pred_direcs[v];
+        for(size_t k = 0; k < preds_v.size(); k++)
+        {
+            EdgeDirection dc0 = direcs_v[k];
+            bool parallel;
+            if(dc != GENERAL && dc0 != GENERAL)
+                parallel = same_axis(dc, dc0);
+            else
             {
-                size_t u = nb.first;
-                double w = nb.second;
-                if (visited[u]) continue;
                 Point d = g_.vertex(u) - g_.vertex(v);
-                CB pont(cb_[v].first+w,cb_[v].second+1,ABS_ERR);
-                for(auto x: predecessors_[v])
+                Point direc0 = g_.vertex(v)-g_.vertex(preds_v[k]);
+                parallel = d.IsWeakParallel(direc0,g_.REL_ERR(),g_.WEAK_PARALLEL_ERR());
+            }
+            if(parallel)
+                return k;
+        }
+        return numeric_limits<size_t>::max();
+    }
+
+    void MinBendShortestPath::expand_lists(MbspWorkspace& ws, size_t v)
+    {
+        double ABS_ERR = g_.REL_ERR();
+        using CB = ewd::CostBend;
+        const CsrGraph& csr = *csr_;
+        const CB cbv = ws.label[v];
+        csr.for_each_neighbor(v, [&](size_t i, double w)
+        {
+            size_t u = csr.neighbor(i);
+            EdgeDirection dc = csr.direction(i);
+            ws.touch(u);
+            if (ws.settled[u] && !incremental_) return;
+            CB pont(cbv.first+w,cbv.second+1,ABS_ERR);
+            if(straight_pred(ws, v, u, dc) != numeric_limits<size_t>::max())
+                pont.second -= 1;
+            if(pont < ws.label[u])
+            {
+                ws.settled[u] = 0; // 增量求解中加入新起点后，已确定的顶点可能变优
+                ws.label[u] = pont;
+                ws.source[u] = ws.source[v];
+                ws.heap_update(u, heap_key(ws, u, pont));
+                ws.preds[u].assign(1, v);
+                ws.pred_direcs[u].assign(1, dc);
+            }
+            else if(!ws.settled[u] && !(ws.label[u]<pont) && ws.source[u] == ws.source[v])
+            {
+                // 多起点求解中，等价前继只取同一区域的，否则区域边界上的回头边会被当作共线
+                ws.preds[u].push_back(v);
+                ws.pred_direcs[u].push_back(dc);
+            }
+        });
+    }
+
+    size_t MinBendShortestPath::solve_lists(const vecIndex& targets, size_t num_left)
+    {
+        size_t n = g_.num_vertex();
+
+        // 所有未确定的目标均优于v时，无需从v扩展
+        auto beyond_targets = [&](size_t v)
+        {
+            for(size_t t : targets)
+            {
+                if(t < n && !ws_.settled[t] && !(ws_.label[t] < ws_.label[v]))
+                    return false;
+            }
+            return true;
+        };
+
+        while (!ws_.heap_empty())
+        {
+            size_t v = ws_.heap_pop();
+            ws_.settled[v] = 1;
+            if (ws_.target[v])
+            {
+                if (incremental_)
                 {
-                    Point direc0 = g_.vertex(v)-g_.vertex(x); 
-                    if(d.IsWeakParallel(direc0,REL_ERR,WEAK_PARA_ERR))
-                    {
-                        pont.second -= 1;
-                        break;
-                    }
+                    ws_.target[v] = 0;
+                    return v;
                 }
-                if(pont < h.get(u))
+                if (--num_left == 0)
+                    break;
+            }
+            if (num_left > 0 && beyond_targets(v))
+                continue;
+            expand_lists(ws_, v);
+        }
+        return numeric_limits<size_t>::max();
+    }
+
+    size_t MinBendShortestPath::solve_states(size_t num_left)
+    {
+        double ABS_ERR = g_.REL_ERR();
+        using CB = ewd::CostBend;
+        const CsrGraph& csr = *csr_;
+
+        // 状态数为顶点数的数倍而实际到达的很少，使用惰性删除的堆，只存放到达过的状态
+        vector<pair<CB, size_t>>& h = ws_.state_heap;
+
+        while (!h.empty())
+        {
+            pop_heap(h.begin(), h.end(), state_later);
+            size_t s = h.back().second;
+            h.pop_back();
+            if (ws_.state_settled[s])
+                continue;
+            ws_.state_settled[s] = 1;
+            size_t v = s / NUM_STATE, din = s % NUM_STATE;
+            // 增量求解中加入新起点后，已确定的顶点可能变优
+            bool improved = incremental_ && ws_.settled[v] && ws_.state_label[s] < ws_.state_label[ws_.best_state[v]];
+            if (!ws_.settled[v] || improved)
+            {
+                // 首个出堆的状态即为该顶点的最优解
+                ws_.settled[v] = 1;
+                ws_.best_state[v] = s;
+                ws_.label[v] = ws_.state_label[s];
+                ws_.source[v] = ws_.state_source[s];
+                if (ws_.state_pred[s] != numeric_limits<size_t>::max())
+                    ws_.preds[v].assign(1, ws_.state_pred[s] / NUM_STATE);
+                else
+                    ws_.preds[v].clear();
+                if (ws_.target[v])
                 {
-                    h.update(u,pont);
-                    predecessors_[u] = {v};
+                    if (incremental_)
+                    {
+                        ws_.target[v] = 0;
+                        return v;
+                    }
+                    if (--num_left == 0)
+                        break;
                 }
-                else if(!(h.get(u)<pont))
+            }
+            else if (!(ws_.state_label[s] < ws_.label[v] + CB(0.0,1)))
+            {
+                // 从最优状态出发至多多一次弯折，该状态不可能更优
+                continue;
+            }
+            const CB cbs = ws_.state_label[s];
+            csr.for_each_neighbor(v, [&](size_t i, double w)
+            {
+                EdgeDirection dout = csr.direction(i);
+                size_t u = csr.neighbor(i);
+                size_t t = u * NUM_STATE + dout;
+                ws_.touch(u);
+                ws_.touch_state(t);
+                if (ws_.state_settled[t] && !incremental_) return;
+                // 与进入方向共线不计弯折；无法量化的方向总计弯折
+                bool straight = din != NO_DIREC && same_axis(EdgeDirection(din), dout);
+                CB cb(cbs.first + w, cbs.second + (straight ? 0 : 1), ABS_ERR);
+                // label[u]为u各状态的当前最优值
+                if (!(cb < ws_.label[u] + CB(0.0,1)))
+                    return;
+                if (cb < ws_.label[u])
+                    ws_.label[u] = cb;
+                if (cb < ws_.state_label[t])
                 {
-                    predecessors_[u].push_back(v);
+                    ws_.state_settled[t] = 0;
+                    ws_.state_label[t] = cb;
+                    ws_.state_pred[t] = s;
+                    ws_.state_source[t] = ws_.state_source[s];
+                    h.push_back(make_pair(heap_key(ws_, u, cb), t));
+                    push_heap(h.begin(), h.end(), state_later);
                 }
-            }
+            });
         }
+        return numeric_limits<size_t>::max();
     }
 
     vecIndex MinBendShortestPath::predecessors(size_t v) const 
     {
-        if(v>=predecessors_.size()) return {};
-        return predecessors_[v];
+        if(!ws_.touched(v)) return {};
+        return ws_.preds[v];
     }
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 ﻿#pragma once
 #include "base/graph.h"
+#include "algorithms/dary_heap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 
 namespace ewd
 {
@@ -38,10 +43,13 @@ namespace ewd
             return *this;
         }
 
+        // 弯折数饱和相加：未到达顶点的弯折数为int最大值，累加后仍为最大值
         CostBend& operator+=(const CostBend& r)
         {
             first += r.first;
-            second += r.second;
+            long long b = (long long)second + r.second;
+            second = b > std::numeric_limits<int>::max() ? std::numeric_limits<int>::max()
+                   : b < std::numeric_limits<int>::min() ? std::numeric_limits<int>::min() : int(b);
             return *this;
         }
 
@@ -53,13 +61,221 @@ namespace ewd
         }
     };
 
+    // 压缩键自高到低依次为代价、弯折数、同键时的先后
+    const int PACKED_BEND_BITS = 12;
+    const int PACKED_TIE_BITS = 16;
+    const int PACKED_COST_BITS = 64 - PACKED_BEND_BITS - PACKED_TIE_BITS;
+
+    /**
+     * @brief 把(代价, 弯折数)压成一个64位整数，整数的大小即字典序
+     * 代价按resolution向下取整，弯折数加一（起点为-1），超出位数时取最大值。
+     * 向下取整后的代价不超过原代价，仍是下界。
+     *
+     * @param tie [0, 1]内的数，代价与弯折数都相同时小者在前
+     */
+    inline uint64_t pack_cost_bend(const CostBend& cb, double resolution, double tie = 0.0)
+    {
+        const uint64_t MAX_COST = (uint64_t(1) << PACKED_COST_BITS) - 1;
+        const uint64_t MAX_BEND = (uint64_t(1) << PACKED_BEND_BITS) - 1;
+        const uint64_t MAX_TIE = (uint64_t(1) << PACKED_TIE_BITS) - 1;
+        double q = std::floor(cb.first / resolution);
+        uint64_t c = q > 0.0 ? (q < double(MAX_COST) ? uint64_t(q) : MAX_COST) : 0;
+        int64_t b = int64_t(cb.second) + 1;
+        uint64_t bb = b > 0 ? (uint64_t(b) < MAX_BEND ? uint64_t(b) : MAX_BEND) : 0;
+        uint64_t t = tie > 0.0 ? (tie < 1.0 ? uint64_t(tie * MAX_TIE) : MAX_TIE) : 0;
+        return (((c << PACKED_BEND_BITS) | bb) << PACKED_TIE_BITS) | t;
+    }
+
+    /**
+     * @brief 由压缩键还原CostBend，代价精确到resolution
+     */
+    inline CostBend unpack_cost_bend(uint64_t key, double resolution, double err = 1e-6)
+    {
+        const uint64_t MAX_BEND = (uint64_t(1) << PACKED_BEND_BITS) - 1;
+        key >>= PACKED_TIE_BITS;
+        return CostBend(double(key >> PACKED_BEND_BITS) * resolution, int(key & MAX_BEND) - 1, err);
+    }
+
+    /**
+     * @brief 最少弯折最短路的求解空间
+     * 按图的规模分配一次，之后每次求解只递增代数。顶点或状态的数据在首次访问时
+     * 按代数标记初始化，求解只触及实际访问的顶点，无需整体清空。
+     */
+    class MbspWorkspace
+    {
+    public:
+        std::vector<CostBend> label;                      // 顶点的代价
+        matIndex preds;                                   // 顶点的前继，保留容量以免重复分配
+        std::vector<std::vector<EdgeDirection>> pred_direcs; // 各前继指向该顶点的方向
+        std::vector<char> settled;                        // 顶点是否已确定
+        std::vector<char> target;                         // 顶点是否为目标
+        vecIndex best_state;                              // DIRECTION_STATES：顶点代价最小的状态
+        vecIndex source;                                  // 顶点所属的起点
+        std::vector<CostBend> state_label;                // DIRECTION_STATES：状态的代价
+        vecIndex state_pred;                              // DIRECTION_STATES：状态的前继状态
+        vecIndex state_source;                            // DIRECTION_STATES：状态所属的起点
+        std::vector<char> state_settled;                  // DIRECTION_STATES：状态是否已确定
+        std::vector<std::pair<CostBend, size_t>> state_heap; // DIRECTION_STATES：惰性删除的堆
+
+        /**
+         * @brief 开始新的一次求解，规模变化时重新分配
+         *
+         * @param num_vertex 顶点数
+         * @param num_state 状态数，不使用状态时为0
+         * @param init 未访问顶点、状态的代价
+         * @param key_resolution 大于0时顶点堆使用该精度的压缩键
+         */
+        void prepare(size_t num_vertex, size_t num_state, const CostBend& init, double key_resolution = 0.0);
+
+        size_t num_vertex() const { return stamp_.size(); }
+        bool touched(size_t v) const { return v < stamp_.size() && stamp_[v] == generation_; }
+        bool state_touched(size_t s) const { return s < state_stamp_.size() && state_stamp_[s] == generation_; }
+        const vecIndex& touched_vertices() const { return touched_; }      // 本次求解访问过的顶点，按首次访问的顺序
+        const vecIndex& touched_states() const { return touched_states_; } // 本次求解访问过的状态，按首次访问的顺序
+
+        /**
+         * @brief 本次求解中首次访问时初始化顶点的数据
+         */
+        void touch(size_t v)
+        {
+            if (stamp_[v] == generation_) return;
+            stamp_[v] = generation_;
+            touched_.push_back(v);
+            label[v] = init_;
+            preds[v].clear();
+            pred_direcs[v].clear();
+            settled[v] = 0;
+            target[v] = 0;
+            best_state[v] = std::numeric_limits<size_t>::max();
+            source[v] = std::numeric_limits<size_t>::max();
+        }
+        void touch_state(size_t s)
+        {
+            if (state_stamp_[s] == generation_) return;
+            state_stamp_[s] = generation_;
+            touched_states_.push_back(s);
+            state_label[s] = init_;
+            state_pred[s] = std::numeric_limits<size_t>::max();
+            state_source[s] = std::numeric_limits<size_t>::max();
+            state_settled[s] = 0;
+        }
+
+        // 顶点堆，只含本次求解到达过的顶点；键为代价加到目标的下界，不使用A*时即为代价
+        bool heap_empty() const { return packed() ? packed_heap_.empty() : heap_.empty(); }
+        size_t heap_top() const { return packed() ? packed_heap_.top() : heap_.top(); }
+        CostBend heap_top_key() const // 压缩键还原后不超过原键
+        {
+            return packed() ? unpack_cost_bend(packed_heap_.top_key(), key_resolution_, init_.err) : heap_.top_key().key;
+        }
+        void heap_update(size_t v, const CostBend& key) // label[v]已更新，键减小或首次插入
+        {
+            if (packed())
+                packed_heap_.update(v, pack_cost_bend(key, key_resolution_, key.first > 0.0 ? label[v].first / key.first : 0.0));
+            else
+                heap_.update(v, HeapKey{key, key.first - label[v].first});
+        }
+        size_t heap_pop() { return packed() ? packed_heap_.pop() : heap_.pop(); }
+
+    private:
+        struct HeapKey
+        {
+            CostBend key;
+            double bound; // 到目标的下界
+        };
+        // 键相近时下界大者（代价小者）优先，使等价前继先于后继确定
+        struct HeapKeyLess
+        {
+            bool operator()(const HeapKey& a, const HeapKey& b) const
+            {
+                if (a.key < b.key) return true;
+                if (b.key < a.key) return false;
+                return a.bound > b.bound;
+            }
+        };
+
+        uint32_t generation_ = 0;
+        CostBend init_;
+        std::vector<uint32_t> stamp_, state_stamp_;
+        vecIndex touched_, touched_states_;
+        DaryHeap<HeapKey, 4, HeapKeyLess> heap_;
+        // 压缩键的堆：整数比较，每项8字节的键；代价与弯折数相同时按代价占键的比例区分先后，与heap_一致
+        DaryHeap<uint64_t, 4> packed_heap_;
+        double key_resolution_ = 0.0;
+        bool packed() const { return key_resolution_ > 0.0; }
+    };
+
+    /**
+     * @brief 最少弯折最短路的求解方式
+     *
+     */
+    enum class BendMode
+    {
+        PREDECESSOR_LISTS, // 每个顶点保留所有等价前继，按几何方向判断弯折
+        DIRECTION_STATES   // 在（顶点，进入方向）状态上求解，方向量化为六个轴向和其他
+    };
+
+    /**
+     * @brief 单个起点的最短路树的紧凑副本
+     * 只保留已确定顶点的前继，之后可从中提取路径而无需重新求解。
+     * 顶点与状态按编号升序稀疏存放，大小与求解访问过的部分成正比，与图的规模无关。
+     */
+    struct PathTree
+    {
+        static const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        size_t root = std::numeric_limits<size_t>::max();
+        BendMode mode = BendMode::PREDECESSOR_LISTS;
+        std::vector<uint32_t> vertices;    // 已确定的顶点，升序
+        std::vector<uint32_t> offsets;     // PREDECESSOR_LISTS：vertices[i]的前继的起始位置
+        std::vector<uint32_t> preds;       // PREDECESSOR_LISTS：前继顶点；DIRECTION_STATES：states[i]的前继状态
+        std::vector<EdgeDirection> direcs; // PREDECESSOR_LISTS：各前继指向该顶点的方向
+        std::vector<uint32_t> best_state;  // DIRECTION_STATES：vertices[i]代价最小的状态
+        std::vector<uint32_t> states;      // DIRECTION_STATES：有前继的已确定状态，升序
+
+        bool empty() const { return root == std::numeric_limits<size_t>::max(); }
+        size_t memory() const
+        {
+            return (vertices.size() + offsets.size() + preds.size() + best_state.size() + states.size()) * sizeof(uint32_t) + direcs.size();
+        }
+
+        /**
+         * @brief v在vertices中的位置，二分查找，未确定时为NONE
+         */
+        size_t vertex_index(size_t v) const { return search(vertices, v); }
+        size_t state_index(size_t s) const { return search(states, s); }
+
+    private:
+        static size_t search(const std::vector<uint32_t>& a, size_t x)
+        {
+            if (x >= NONE) return NONE;
+            auto it = std::lower_bound(a.begin(), a.end(), uint32_t(x));
+            return it != a.end() && *it == x ? size_t(it - a.begin()) : size_t(NONE);
+        }
+    };
 
     class MinBendShortestPath
     {
     public:
-        MinBendShortestPath(GeometricGraph& g):g_(g) {}
+        BendMode mode = BendMode::PREDECESSOR_LISTS;
+        bool use_astar = true; // 单起点、单目标时按A*求解，以边的最小单位长度代价乘到目标的距离为下界
+        double key_resolution = 0.0; // 大于0时堆键的代价按此精度量化，与弯折数压成64位整数比较，代价误差不超过该精度；DIRECTION_STATES的状态堆不受影响
+
+        MinBendShortestPath(SpatialGraph& g):g_(g) {}
+
+        /**
+         * @brief 复制求解方式并共享冻结的图，求解结果不复制
+         * 副本拥有独立的堆、标签和前继，可在其他线程上求解
+         */
+        MinBendShortestPath(const MinBendShortestPath& other)
+            : mode(other.mode), use_astar(other.use_astar), key_resolution(other.key_resolution), g_(other.g_), csr_(other.csr_), csr_version_(other.csr_version_),
+              unit_cost_(other.unit_cost_), axis_only_(other.axis_only_) {}
         ~MinBendShortestPath() {}
 
+        /**
+         * @brief 图被修改后重建冻结的图；多线程复制求解器前调用，以共享同一冻结图
+         */
+        void freeze();
+
         size_t get_predecessor_num(size_t v) const;
         size_t predecessor(size_t v, size_t n_pred) const;
         double distance(size_t v) const;
@@ -67,16 +283,120 @@ namespace ewd
         bool get_path(size_t v, vecIndex& pathvec, size_t n_direc=0) const;
         vecIndex get_path(size_t v, size_t n_direc=0) const;
 
+        /**
+         * @brief 从保存的最短路树中提取路径，规则与求解后直接提取相同
+         *
+         * @param tree 由export_tree()得到的最短路树，须来自同一张图
+         * @param v 终点，须在该次求解中已确定
+         * @param pathvec 起点到v的路径
+         * @param n_direc 终点的前继序号
+         * @return true
+         * @return false v不可达或未确定
+         */
+        bool get_path(const PathTree& tree, size_t v, vecIndex& pathvec, size_t n_direc=0) const;
+
+        /**
+         * @brief 导出最近一次求解的最短路树
+         *
+         * @return PathTree 顶点或状态数超出32位编号时为空
+         */
+        PathTree export_tree() const;
+
         void solve(size_t root, size_t expected_end_node = std::numeric_limits<size_t>::max());
 
+        /**
+         * @brief 求解root到各顶点的最少弯折最短路，所有目标顶点确定后即停止
+         * 已确定顶点的距离、前继与完整求解的结果相同
+         *
+         * @param root 起点
+         * @param targets 目标顶点，为空时求解全图
+         */
+        void solve(size_t root, const vecIndex& targets);
+
+        /**
+         * @brief 多起点求解，每个顶点归属于代价最小的起点（Voronoi区域）
+         * 各起点的代价均为0，路径从所属起点开始；此后export_tree()为空
+         *
+         * @param roots 起点
+         * @param targets 目标顶点，为空时求解全图
+         */
+        void solve_multi_source(const vecIndex& roots, const vecIndex& targets = vecIndex());
+
+        /**
+         * @brief 顶点所属的起点，未到达时为size_t最大值
+         */
+        size_t source(size_t v) const;
+
+        /**
+         * @brief u、v的最优路径经边(u, v)相接后的弯折数，规则与solve_bidirectional()的相接处相同
+         * 只用两端的标签和前继，无需展开路径；u或v未到达时为int最大值
+         */
+        int num_bend_through(size_t u, size_t v) const;
+
+        /**
+         * @brief u、v所属起点经边(u, v)相连的路径，弯折数与num_bend_through()相同
+         * 两端有多个等价前继时，优先选择与边共线的一个；u或v未到达时为空
+         */
+        vecIndex path_through(size_t u, size_t v) const;
+
+        /**
+         * @brief 多起点求解，第一个目标顶点确定后即停止，之后可用grow_sources()继续
+         *
+         * @param roots 起点
+         * @param targets 目标顶点
+         * @return size_t 距起点最近的目标，均不可达时为size_t最大值
+         */
+        size_t solve_nearest(const vecIndex& roots, const vecIndex& targets);
+
+        /**
+         * @brief 在solve_nearest()的结果上加入代价为0的新起点并继续求解
+         * 保留上次的堆与标签，只重新扩展因新起点而变优的顶点；已返回的目标不再返回
+         *
+         * @param roots 新起点，例如刚连入的路径上的顶点
+         * @return size_t 距所有起点最近的下一个目标，均不可达时为size_t最大值
+         */
+        size_t grow_sources(const vecIndex& roots);
+
+        /**
+         * @brief 双向求解root到target的最少弯折最短路，两侧搜索在中间的边上相接
+         * 两侧堆顶代价之和超过当前最优路径（含误差）时停止，相接处按两侧前继的方向计算弯折。
+         * 之后distance(target)、num_bend(target)、get_path(target)给出结果，其他顶点的结果无意义，
+         * export_tree()为空。DIRECTION_STATES方式下按单向求解。
+         *
+         * @param root 起点
+         * @param target 终点
+         */
+        void solve_bidirectional(size_t root, size_t target);
+
         vecIndex predecessors(size_t v) const;
 
     private:
-        GeometricGraph &g_;
-        size_t root_;
-        matIndex predecessors_;
-        std::vector<CostBend> cb_;
-        void reset();
+        SpatialGraph &g_;
+        size_t root_ = std::numeric_limits<size_t>::max();
+        MbspWorkspace ws_;
+        MbspWorkspace back_ws_; // 双向求解中由终点出发的一侧
+        std::shared_ptr<const CsrGraph> csr_; // g_的冻结视图，图被修改后在下次求解时重建
+        size_t csr_version_ = std::numeric_limits<size_t>::max();
+        double unit_cost_ = 0.0;  // 边权与边长之比的最小值，冻结时计算
+        bool axis_only_ = false;  // 所有边均沿坐标轴，此时以曼哈顿距离为下界
+        size_t astar_target_ = std::numeric_limits<size_t>::max(); // A*的目标，不使用A*时为size_t最大值
+        Point astar_point_;
+        size_t astar_source_ = std::numeric_limits<size_t>::max(); // 双向A*的起点，单向时为size_t最大值
+        Point astar_source_point_;
+        bool incremental_ = false; // 由solve_nearest()开始，目标逐个返回，已确定的顶点可重新打开
+        size_t pending_ = std::numeric_limits<size_t>::max(); // 增量求解中上次返回、尚未扩展的目标
+        void run(const vecIndex& roots, const vecIndex& targets);
+        void start(bool incremental);
+        double lower_bound(const Point& p, size_t v) const; // v到p的代价下界
+        CostBend heap_key(const MbspWorkspace& ws, size_t v, const CostBend& cb) const;
+        size_t mark_targets(const vecIndex& targets);
+        void add_roots(const vecIndex& roots);
+        size_t search(const vecIndex& targets, size_t num_left);
+        size_t solve_lists(const vecIndex& targets, size_t num_left);
+        size_t straight_pred(const MbspWorkspace& ws, size_t v, size_t u, EdgeDirection dc) const; // 与v->u共线的前继序号，没有时为size_t最大值
+        int joint_bends(const MbspWorkspace& a, size_t x, const MbspWorkspace& b, size_t y, EdgeDirection dc) const; // a中x、b中y的路径经边x->y（方向dc）相接后的弯折数
+        void expand_lists(MbspWorkspace& ws, size_t v);
+        size_t solve_states(size_t num_left);
     };
 
 }
@@ -1,5 +1,5 @@
 #include "algorithms/mst.h"
-#include "algorithms/argheap.h"
+#include "algorithms/dary_heap.h"
 
 using namespace std;
 #include <algorithm>
@@ -15,28 +15,31 @@ namespace ewd
         
         VertexIndex v;
         CostBend total_weight(0.0,0,REL_ERR);
-        ArgHeap<CostBend> h(vector<CostBend>(g.num_vertex(), CostBend(numeric_limits<double>::max(), numeric_limits<int>::max(), REL_ERR)));
+        DaryHeap<CostBend> h(g.num_vertex());
         vector<EdgeIndex> pred_edges(g.num_vertex(), numeric_limits<EdgeIndex>::max());
         vector<bool> visited(g.num_vertex(), false);
-        h.update(0, CostBend(0.0,0,REL_ERR));
 
-        while (h.size() > 0)
+        for (VertexIndex s = 0; s < g.num_vertex(); s++)
         {
-            v = h.pop();
-            visited[v] = true;
-            if (pred_edges[v] != numeric_limits<EdgeIndex>::max())
+            if (visited[s])
+                continue;
+            h.update(s, CostBend(0.0,0,REL_ERR));
+            while (!h.empty())
             {
-                treeset.push_back(pred_edges[v]);
-                total_weight += weights[pred_edges[v]];
-            }
-            for (auto e : g.GetAdjacentEdges(v))
-            {
-                if (!visited[g.opposite(v,e)])
+                v = h.pop();
+                visited[v] = true;
+                if (pred_edges[v] != numeric_limits<EdgeIndex>::max())
+                {
+                    treeset.push_back(pred_edges[v]);
+                    total_weight += weights[pred_edges[v]];
+                }
+                for (auto e : g.GetAdjacentEdges(v))
                 {
-                    if (weights[e] < h.get(g.opposite(v,e)))
+                    VertexIndex u = g.opposite(v,e);
+                    if (!visited[u] && (!h.contains(u) || weights[e] < h.key(u)))
                     {
-                        h.update(g.opposite(v,e), weights[e]);
-                        pred_edges[g.opposite(v,e)] = e;
+                        h.update(u, weights[e]);
+                        pred_edges[u] = e;
                     }
                 }
             }
@@ -44,4 +47,132 @@ namespace ewd
 
         return treeset;
     }
+
+    vector<EdgeIndex> PrimMinimumSpanningTree(
+        const ewd::CsrGraph &g,
+        const std::vector<CostBend>& weights, 
+        double REL_ERR)
+    {
+        return PrimMinimumSpanningTree<DaryHeap<CostBend>>(g, weights, REL_ERR);
+    }
+
+    vector<pair<size_t, size_t>> DensePrimMinimumSpanningTree(
+        const vector<CostBend>& dist,
+        size_t N)
+    {
+        const size_t NONE = numeric_limits<size_t>::max();
+        const double INF = numeric_limits<double>::infinity();
+        vector<pair<size_t, size_t>> treeset;
+        vector<char> in_tree(N, 0);
+        vector<size_t> parent(N, NONE);
+        vector<CostBend> best(N, CostBend(INF, 0));
+
+        for (size_t k = 0; k < N; k++)
+        {
+            // 树外距树最近的顶点；其余均不连通时另起一棵树
+            size_t u = NONE;
+            for (size_t v = 0; v < N; v++)
+            {
+                if (!in_tree[v] && (u == NONE || best[v] < best[u]))
+                    u = v;
+            }
+            in_tree[u] = 1;
+            if (parent[u] != NONE)
+                treeset.push_back(make_pair(min(parent[u], u), max(parent[u], u)));
+            const CostBend *row = &dist[u * N];
+            for (size_t v = 0; v < N; v++)
+            {
+                if (!in_tree[v] && row[v].first != INF && row[v] < best[v])
+                {
+                    best[v] = row[v];
+                    parent[v] = u;
+                }
+            }
+        }
+        return treeset;
+    }
+
+    vector<size_t> KruskalMinimumSpanningTree(
+        size_t N,
+        const vector<pair<size_t, size_t>>& edges,
+        const vector<CostBend>& weights)
+    {
+        vector<size_t> order;
+        for (size_t k = 0; k < edges.size(); k++)
+        {
+            if (edges[k].first != edges[k].second && weights[k].first != numeric_limits<double>::infinity())
+                order.push_back(k);
+        }
+        // 带误差的比较不满足传递性，排序用精确的字典序
+        sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            if (weights[a].first != weights[b].first)
+                return weights[a].first < weights[b].first;
+            if (weights[a].second != weights[b].second)
+                return weights[a].second < weights[b].second;
+            return a < b;
+        });
+
+        vector<size_t> parent(N), rank(N, 0);
+        for (size_t v = 0; v < N; v++)
+            parent[v] = v;
+        auto find_root = [&](size_t v)
+        {
+            while (parent[v] != v)
+            {
+                parent[v] = parent[parent[v]];
+                v = parent[v];
+            }
+            return v;
+        };
+
+        vector<size_t> treeset;
+        for (size_t k : order)
+        {
+            size_t a = find_root(edges[k].first), b = find_root(edges[k].second);
+            if (a == b)
+                continue;
+            if (rank[a] < rank[b])
+                swap(a, b);
+            parent[b] = a;
+            if (rank[a] == rank[b])
+                rank[a]++;
+            treeset.push_back(k);
+            if (treeset.size() + 1 == N)
+                break;
+        }
+        return treeset;
+    }
+
+    vector<pair<size_t, size_t>> MinimumSpanningTree(
+        const vector<CostBend>& dist,
+        size_t N)
+    {
+        const double INF = numeric_limits<double>::infinity();
+        // 矩阵的每一项对应一对不同的顶点，有限项数即相连的顶点对数，平行边不会误计
+        size_t m = 0;
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+                m += dist[i * N + j].first != INF;
+        }
+        if (N > 1 && (2 * m == N * (N - 1) || m > 2 * N))
+            return DensePrimMinimumSpanningTree(dist, N);
+
+        vector<pair<size_t, size_t>> pairs, treeset;
+        vector<CostBend> weights;
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (dist[i * N + j].first == INF)
+                    continue;
+                pairs.push_back(make_pair(i, j));
+                weights.push_back(dist[i * N + j]);
+            }
+        }
+        for (size_t k : KruskalMinimumSpanningTree(N, pairs, weights))
+            treeset.push_back(pairs[k]);
+        return treeset;
+    }
 }
\ No newline at end of file
@@ -1,10 +1,114 @@
 ﻿#pragma once
 #include "base/graph.h"
 #include "algorithms/mbsp.h"
+#include "algorithms/dary_heap.h"
+#include <limits>
 namespace ewd
 {
     std::vector<size_t> PrimMinimumSpanningTree(
         const ewd::EssentialGraph &g,
         const std::vector<CostBend>& weights, 
         double REL_ERR=0.01);
+
+    /**
+     * @brief 在冻结的图上求最小生成树
+     *
+     * @param g 冻结的图
+     * @param weights 按边编号的权重
+     * @param REL_ERR 权重比较的误差
+     * @return std::vector<size_t> 树边编号
+     */
+    std::vector<size_t> PrimMinimumSpanningTree(
+        const ewd::CsrGraph &g,
+        const std::vector<CostBend>& weights, 
+        double REL_ERR=0.01);
+
+    /**
+     * @brief 以指定的堆在冻结的图上求最小生成树，不连通时为生成森林
+     * 顶点首次被发现时才入堆，代价为无穷大的边视为不存在。
+     *
+     * @tparam Heap 以CostBend为键的索引堆，须提供Heap(n)、update、pop、empty、contains、key，如DaryHeap<CostBend, 4>
+     * @param g 冻结的图
+     * @param weights 按边编号的权重
+     * @param REL_ERR 权重比较的误差
+     * @return std::vector<size_t> 树边编号
+     */
+    template <typename Heap>
+    std::vector<size_t> PrimMinimumSpanningTree(
+        const ewd::CsrGraph &g,
+        const std::vector<CostBend>& weights,
+        double REL_ERR=0.01)
+    {
+        const size_t NONE = std::numeric_limits<size_t>::max();
+        std::vector<size_t> treeset;
+        Heap h(g.num_vertex());
+        std::vector<size_t> pred_edges(g.num_vertex(), NONE);
+        std::vector<bool> visited(g.num_vertex(), false);
+
+        for (size_t s = 0; s < g.num_vertex(); s++)
+        {
+            if (visited[s])
+                continue;
+            h.update(s, CostBend(0.0, 0, REL_ERR));
+            while (!h.empty())
+            {
+                size_t v = h.pop();
+                visited[v] = true;
+                if (pred_edges[v] != NONE)
+                    treeset.push_back(pred_edges[v]);
+                for (size_t i = g.begin(v); i < g.end(v); i++)
+                {
+                    size_t u = g.neighbor(i);
+                    size_t e = g.edge_id(i);
+                    if (visited[u] || weights[e].first == std::numeric_limits<double>::infinity())
+                        continue;
+                    if (!h.contains(u) || weights[e] < h.key(u))
+                    {
+                        h.update(u, weights[e]);
+                        pred_edges[u] = e;
+                    }
+                }
+            }
+        }
+        return treeset;
+    }
+
+    /**
+     * @brief 完全图上O(N^2)的Prim：不用堆，也不建图
+     * 适用于终端之间的距离矩阵，代价为无穷大的项视为不连通，此时为生成森林。
+     *
+     * @param dist 按行存放的N×N距离矩阵，须对称
+     * @param N 顶点数
+     * @return std::vector<std::pair<size_t, size_t>> 树边(i, j)，i < j
+     */
+    std::vector<std::pair<size_t, size_t>> DensePrimMinimumSpanningTree(
+        const std::vector<CostBend>& dist,
+        size_t N);
+
+    /**
+     * @brief 以并查集按Kruskal求最小生成树，适用于稀疏图
+     * 按(代价, 弯折数)精确排序，不使用误差；代价为无穷大的边视为不存在。
+     *
+     * @param N 顶点数
+     * @param edges 边的两端
+     * @param weights 按edges编号的权重
+     * @return std::vector<size_t> 树边在edges中的编号
+     */
+    std::vector<size_t> KruskalMinimumSpanningTree(
+        size_t N,
+        const std::vector<std::pair<size_t, size_t>>& edges,
+        const std::vector<CostBend>& weights);
+
+    /**
+     * @brief 终端图的最小生成树，按图的疏密选择方法
+     * 有限项构成完全图或多于2N对时用DensePrimMinimumSpanningTree，否则在有限项上用Kruskal；
+     * 代价为无穷大的项视为不连通，此时为生成森林。
+     *
+     * @param dist 按行存放的N×N距离矩阵，须对称
+     * @param N 顶点数
+     * @return std::vector<std::pair<size_t, size_t>> 树边(i, j)，i < j
+     */
+    std::vector<std::pair<size_t, size_t>> MinimumSpanningTree(
+        const std::vector<CostBend>& dist,
+        size_t N);
 } 
@@ -0,0 +1,30 @@
+#include "algorithms/path_tree_store.h"
+
+using namespace std;
+
+namespace ewd
+{
+    bool PathTreeStore::add(PathTree &&tree)
+    {
+        if (tree.empty() || trees_.count(tree.root) > 0)
+            return false;
+        if (bytes_ + tree.memory() > max_bytes_)
+            return false;
+        bytes_ += tree.memory();
+        size_t root = tree.root;
+        trees_[root] = move(tree);
+        return true;
+    }
+
+    const PathTree *PathTreeStore::find(size_t root) const
+    {
+        auto it = trees_.find(root);
+        return it == trees_.end() ? nullptr : &it->second;
+    }
+
+    void PathTreeStore::clear()
+    {
+        trees_.clear();
+        bytes_ = 0;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "algorithms/mbsp.h"
+#include <map>
+
+namespace ewd
+{
+    /**
+     * @brief 多个起点的最短路树
+     * 保存各起点求解后的紧凑最短路树，供之后提取路径。
+     * 总内存超出上限的树不予保存，使用方应重新求解。
+     */
+    class PathTreeStore
+    {
+    public:
+        PathTreeStore(size_t max_bytes = size_t(64) << 20) : max_bytes_(max_bytes) {}
+        ~PathTreeStore() {}
+
+        /**
+         * @brief 保存最短路树，已保存同一起点的树时保留旧树
+         * 同一起点先求解的树通常确定的顶点更多
+         *
+         * @param tree 最短路树
+         * @return true
+         * @return false 树为空、已有同一起点的树或超出内存上限，未保存
+         */
+        bool add(PathTree &&tree);
+
+        /**
+         * @brief 查找起点为root的最短路树
+         *
+         * @param root 起点
+         * @return const PathTree* 未保存时为nullptr
+         */
+        const PathTree *find(size_t root) const;
+
+        size_t memory() const { return bytes_; }
+        size_t max_memory() const { return max_bytes_; }
+        void clear();
+
+    private:
+        size_t max_bytes_;
+        size_t bytes_ = 0;
+        std::map<size_t, PathTree> trees_;
+    };
+}
@@ -0,0 +1,197 @@
+#include "algorithms/steiner_tree.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+using namespace std;
+
+namespace ewd
+{
+    size_t DreyfusWagnerMemory(size_t num_vertex, size_t num_terminals)
+    {
+        // 除根以外的每个非空子集各有一张代价表和一张前继表
+        if (num_terminals < 2)
+            return 0;
+        if (num_terminals > 63)
+            return numeric_limits<size_t>::max();
+        size_t per_subset = num_vertex * (sizeof(double) + sizeof(uint32_t));
+        size_t subsets = (size_t(1) << (num_terminals - 1)) - 1;
+        if (per_subset > 0 && subsets > numeric_limits<size_t>::max() / per_subset)
+            return numeric_limits<size_t>::max();
+        return subsets * per_subset;
+    }
+
+    SteinerTree DreyfusWagnerSteinerTree(
+        const CsrGraph &g,
+        const vecIndex &terminals,
+        size_t max_terminals,
+        size_t num_threads,
+        size_t max_bytes)
+    {
+        SteinerTree tree;
+        size_t n = g.num_vertex();
+        vecIndex ts;
+        for (size_t t : terminals)
+        {
+            if (t < n && find(ts.begin(), ts.end(), t) == ts.end())
+                ts.push_back(t);
+        }
+        // 前继与子集共用32位编号
+        if (ts.size() > max_terminals || ts.size() > 31 || n >= (size_t(1) << 31))
+            return tree;
+        if (DreyfusWagnerMemory(n, ts.size()) > max_bytes)
+            return tree;
+        if (ts.size() < 2)
+        {
+            tree.cost = ts.empty() ? tree.cost : 0.0;
+            return tree;
+        }
+
+        // 子集只含除根以外的k个终端
+        const double INF = numeric_limits<double>::infinity();
+        const uint32_t NONE = numeric_limits<uint32_t>::max();
+        const uint32_t SPLIT = uint32_t(1) << 31; // 前继的最高位：由两个子集在该顶点合并
+        size_t k = ts.size() - 1;
+        size_t root = ts.back();
+        size_t full = (size_t(1) << k) - 1;
+        vector<vecDouble> cost(full + 1);
+        vector<vector<uint32_t>> back(full + 1); // 图上的前继顶点，或SPLIT|子集
+
+        // 以cost[S]为初值在图上求最短路，stop确定后即停止
+        auto relax = [&](size_t S, size_t stop)
+        {
+            vecDouble &d = cost[S];
+            vector<uint32_t> &b = back[S];
+            using Entry = pair<double, uint32_t>;
+            vector<Entry> h;
+            for (size_t v = 0; v < n; v++)
+            {
+                if (d[v] < INF)
+                    h.push_back(make_pair(d[v], uint32_t(v)));
+            }
+            make_heap(h.begin(), h.end(), greater<Entry>());
+            while (!h.empty())
+            {
+                pop_heap(h.begin(), h.end(), greater<Entry>());
+                Entry top = h.back();
+                h.pop_back();
+                size_t v = top.second;
+                if (top.first > d[v])
+                    continue;
+                if (v == stop)
+                    break;
+                g.for_each_neighbor(v, [&](size_t i, double w)
+                {
+                    size_t u = g.neighbor(i);
+                    if (top.first + w < d[u])
+                    {
+                        d[u] = top.first + w;
+                        b[u] = uint32_t(v);
+                        h.push_back(make_pair(d[u], uint32_t(u)));
+                        push_heap(h.begin(), h.end(), greater<Entry>());
+                    }
+                });
+            }
+        };
+
+        auto solve_subset = [&](size_t S)
+        {
+            vecDouble &d = cost[S];
+            vector<uint32_t> &b = back[S];
+            d.assign(n, INF);
+            b.assign(n, NONE);
+            size_t low = S & (~S + 1);
+            if (S == low)
+            {
+                size_t i = 0;
+                while ((size_t(1) << i) != S)
+                    i++;
+                d[ts[i]] = 0.0;
+            }
+            else
+            {
+                // 只取含最低位的真子集，每种划分只算一次
+                for (size_t S1 = (S - 1) & S; S1 > 0; S1 = (S1 - 1) & S)
+                {
+                    if (!(S1 & low))
+                        continue;
+                    const vecDouble &d1 = cost[S1], &d2 = cost[S ^ S1];
+                    for (size_t v = 0; v < n; v++)
+                    {
+                        double c = d1[v] + d2[v];
+                        if (c < d[v])
+                        {
+                            d[v] = c;
+                            b[v] = SPLIT | uint32_t(S1);
+                        }
+                    }
+                }
+            }
+            relax(S, S == full ? root : numeric_limits<size_t>::max());
+        };
+
+        // 按子集大小分层
+        vector<vecIndex> layers(k + 1);
+        for (size_t S = 1; S <= full; S++)
+        {
+            size_t c = 0;
+            for (size_t x = S; x > 0; x &= x - 1)
+                c++;
+            layers[c].push_back(S);
+        }
+        size_t nt = num_threads > 0 ? num_threads : thread::hardware_concurrency();
+        nt = max<size_t>(1, nt);
+        for (const vecIndex &layer : layers)
+        {
+            atomic<size_t> next(0);
+            auto worker = [&]()
+            {
+                for (size_t j = next++; j < layer.size(); j = next++)
+                    solve_subset(layer[j]);
+            };
+            vector<thread> pool;
+            for (size_t t = 1; t < min(nt, layer.size()); t++)
+                pool.emplace_back(worker);
+            worker();
+            for (auto &th : pool)
+                th.join();
+        }
+        if (cost[full][root] == INF)
+            return tree;
+
+        // 沿前继回溯树边，重复的边只计一次
+        vector<pair<EdgeIndex, double>> found;
+        vector<pair<size_t, size_t>> stack{make_pair(full, root)};
+        while (!stack.empty())
+        {
+            size_t S = stack.back().first, v = stack.back().second;
+            stack.pop_back();
+            uint32_t b = back[S][v];
+            if (b == NONE)
+                continue;
+            if (b & SPLIT)
+            {
+                size_t S1 = b & ~SPLIT;
+                stack.push_back(make_pair(S1, v));
+                stack.push_back(make_pair(S ^ S1, v));
+                continue;
+            }
+            g.for_each_neighbor(b, [&](size_t i, double w)
+            {
+                if (g.neighbor(i) == v)
+                    found.push_back(make_pair(g.edge_id(i), w));
+            });
+            stack.push_back(make_pair(S, size_t(b)));
+        }
+        sort(found.begin(), found.end());
+        found.erase(unique(found.begin(), found.end()), found.end());
+        tree.cost = 0.0;
+        for (auto &e : found)
+        {
+            tree.edges.push_back(e.first);
+            tree.cost += e.second;
+        }
+        return tree;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "base/graph.h"
+#include <limits>
+
+namespace ewd
+{
+    /**
+     * @brief 图上的Steiner树
+     *
+     */
+    struct SteinerTree
+    {
+        double cost = std::numeric_limits<double>::infinity(); // 树边权重之和，未求解或不连通时为无穷大
+        std::vector<EdgeIndex> edges;                           // 树边编号，升序
+
+        bool empty() const { return cost == std::numeric_limits<double>::infinity(); }
+    };
+
+    /**
+     * @brief Dreyfus–Wagner子集动态规划求按边权的Steiner最小树
+     * 以最后一个终端为根，cost[S][v]为连接子集S与顶点v的最小树权重，
+     * 按子集大小分层，同层子集互不依赖，在多个线程上并行。
+     * 时间O(3^k n + 2^k m log n)，内存O(2^k n)，k为终端数，只适用于设备较少的回路。
+     *
+     * @param g 冻结的图
+     * @param terminals 终端顶点，重复的只计一次
+     * @param max_terminals 终端数上限，超出时不求解，返回空树
+     * @param num_threads 线程数，0表示硬件线程数
+     * @param max_bytes 动态规划表的内存上限，超出时不求解，返回空树
+     * @return SteinerTree 最小树，终端之间不连通时为空
+     */
+    SteinerTree DreyfusWagnerSteinerTree(
+        const CsrGraph &g,
+        const vecIndex &terminals,
+        size_t max_terminals = 10,
+        size_t num_threads = 0,
+        size_t max_bytes = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief DreyfusWagnerSteinerTree()的动态规划表占用的字节数
+     *
+     * @param num_vertex 顶点数
+     * @param num_terminals 不重复的终端数
+     */
+    size_t DreyfusWagnerMemory(size_t num_vertex, size_t num_terminals);
+}
@@ -0,0 +1,59 @@
+#include "algorithms/terminal_distances.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace ewd
+{
+    vector<CostBend> terminal_distances(
+        MinBendShortestPath &mbsp,
+        const vecIndex &terminals,
+        double err,
+        size_t num_threads,
+        PathTreeStore *trees)
+    {
+        size_t N = terminals.size();
+        vector<CostBend> dist(N * N, CostBend(0.0, 0, err));
+        if (N < 2)
+            return dist;
+
+        size_t n = num_threads > 0 ? num_threads : thread::hardware_concurrency();
+        n = max<size_t>(1, min(n, N - 1));
+        mbsp.freeze();
+        vector<MinBendShortestPath> solvers(n - 1, mbsp);
+
+        atomic<size_t> next(0);
+        mutex tree_mutex;
+        auto worker = [&](MinBendShortestPath &solver)
+        {
+            for (size_t i = next++; i + 1 < N; i = next++)
+            {
+                solver.solve(terminals[i], vecIndex(terminals.begin() + i + 1, terminals.end()));
+                for (size_t j = i + 1; j < N; j++)
+                    dist[i * N + j] = CostBend(solver.distance(terminals[j]), solver.num_bend(terminals[j]), err);
+                if (trees != nullptr)
+                {
+                    PathTree tree = solver.export_tree();
+                    lock_guard<mutex> lock(tree_mutex);
+                    trees->add(move(tree));
+                }
+            }
+        };
+        vector<thread> pool;
+        for (auto &solver : solvers)
+            pool.emplace_back(worker, ref(solver));
+        worker(mbsp);
+        for (auto &th : pool)
+            th.join();
+
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = 0; j < i; j++)
+                dist[i * N + j] = dist[j * N + i];
+        }
+        return dist;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "algorithms/mbsp.h"
+#include "algorithms/path_tree_store.h"
+
+namespace ewd
+{
+    /**
+     * @brief 多线程求终端两两之间的最少弯折最短路距离
+     * dist[i * N + j]（j>i）由terminals[i]出发、在所有后续终端确定后停止的求解得到，
+     * 下三角按对称填充。各线程复制mbsp，共享同一冻结图，结果与线程数无关。
+     *
+     * @param mbsp 求解器，决定求解方式；调用后其结果为某一终端的求解结果
+     * @param terminals 终端顶点
+     * @param err 距离比较的误差
+     * @param num_threads 线程数，0表示硬件线程数
+     * @param trees 非空时保存各终端的最短路树，已有同一起点的树时不替换
+     * @return std::vector<CostBend> 按行存放的N×N距离矩阵，对角线为0
+     */
+    std::vector<CostBend> terminal_distances(
+        MinBendShortestPath &mbsp,
+        const vecIndex &terminals,
+        double err,
+        size_t num_threads = 0,
+        PathTreeStore *trees = nullptr);
+}
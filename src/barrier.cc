@@ -38,6 +38,25 @@ namespace ewd
         }
     }
 
+    HouseBarrier &HouseBarrier::operator=(const HouseBarrier &br)
+    {
+        name_ = br.name_;
+        id_ = br.id_;
+        start_ = br.start_;
+        end_ = br.end_;
+        length_ = br.length_;
+        height_ = br.height_;
+        thickness_ = br.thickness_;
+        type_ = br.type_;
+        eight_vertex_ = br.eight_vertex_;
+        vert_direc_ = br.vert_direc_;
+        u_ = br.u_;
+        n_ = br.n_;
+        offset_ = br.offset_;
+        this->update_cu();
+        return *this;
+    }
+
     HouseBarrier::~HouseBarrier() {}
 
     void HouseBarrier::update_cu()
@@ -488,6 +507,8 @@ namespace ewd
         z_up_ = wd.z_up_;
         z_low_ = wd.z_low_;
         hostid = wd.hostid;
+        offset_ = wd.offset_;
+        this->update_cu();
         return *this;
     }
 
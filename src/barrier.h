@@ -30,6 +30,7 @@ namespace ewd
 					 double thick,
 					 BarrierType _type = BarrierType::WALL);
 		HouseBarrier(const HouseBarrier &br);
+		HouseBarrier &operator=(const HouseBarrier &br);
 		~HouseBarrier();
 
 	protected:
@@ -107,6 +108,11 @@ namespace ewd
 			 double thick,
 			 BarrierType _type = BarrierType::WALL) : HouseBarrier(sname, sid, ps, pe, h, thick, _type){};
 		Wall(const Wall &wl) : HouseBarrier(wl.name_, wl.id_, wl.start_, wl.end_, wl.height_, wl.thickness_, wl.type_){};
+		Wall &operator=(const Wall &wl)
+		{
+			HouseBarrier::operator=(wl);
+			return *this;
+		}
 	};
 
 	class HouseInwallBarrier : public HouseBarrier
@@ -224,6 +230,8 @@ namespace ewd
 		Door(const Door &wd) : HouseInwallBarrier(wd.name_, wd.id_, wd.start_, wd.end_, wd.height_, wd.thickness_, wd.hostid, wd.type_)
 		{
 			u_l_ = wd.u_l_, u_r_ = wd.u_r_, z_up_ = wd.z_up_, z_low_ = wd.z_low_;
+			offset_ = wd.offset_;
+			this->update_offset_cu();
 		}
 		Door GetUnionWindoor(const Door &wd2) const;
 		Door &operator=(const Door &wd);
@@ -0,0 +1,170 @@
+#include "base/bvh.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace ewd
+{
+    BoundingBox::BoundingBox()
+        : lower(numeric_limits<double>::infinity(), numeric_limits<double>::infinity(), numeric_limits<double>::infinity()),
+          upper(-numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), -numeric_limits<double>::infinity())
+    {
+    }
+
+    BoundingBox::BoundingBox(const Point& p1, const Point& p2)
+        : lower(min(p1.x, p2.x), min(p1.y, p2.y), min(p1.z, p2.z)),
+          upper(max(p1.x, p2.x), max(p1.y, p2.y), max(p1.z, p2.z))
+    {
+    }
+
+    bool BoundingBox::empty() const
+    {
+        return lower.x > upper.x || lower.y > upper.y || lower.z > upper.z;
+    }
+
+    Point BoundingBox::center() const
+    {
+        return Point((lower.x + upper.x) / 2, (lower.y + upper.y) / 2, (lower.z + upper.z) / 2);
+    }
+
+    void BoundingBox::expand(const Point& p)
+    {
+        lower = Point(min(lower.x, p.x), min(lower.y, p.y), min(lower.z, p.z));
+        upper = Point(max(upper.x, p.x), max(upper.y, p.y), max(upper.z, p.z));
+    }
+
+    void BoundingBox::expand(const BoundingBox& b)
+    {
+        if (b.empty())
+            return;
+        expand(b.lower);
+        expand(b.upper);
+    }
+
+    void BoundingBox::inflate(double margin)
+    {
+        lower = lower - Point(margin, margin, margin);
+        upper = upper + Point(margin, margin, margin);
+    }
+
+    bool BoundingBox::overlaps(const BoundingBox& b) const
+    {
+        return lower.x <= b.upper.x && b.lower.x <= upper.x &&
+               lower.y <= b.upper.y && b.lower.y <= upper.y &&
+               lower.z <= b.upper.z && b.lower.z <= upper.z;
+    }
+
+    bool BoundingBox::contains(const Point& p) const
+    {
+        return lower.x <= p.x && p.x <= upper.x &&
+               lower.y <= p.y && p.y <= upper.y &&
+               lower.z <= p.z && p.z <= upper.z;
+    }
+
+    BoundingBox BoundingBox::vertical_column(const Point& p)
+    {
+        BoundingBox b(p, p);
+        b.lower.z = -numeric_limits<double>::infinity();
+        b.upper.z = numeric_limits<double>::infinity();
+        return b;
+    }
+
+    void BoundingVolumeHierarchy::clear()
+    {
+        boxes_.clear();
+        items_.clear();
+        nodes_.clear();
+    }
+
+    void BoundingVolumeHierarchy::build(const vector<BoundingBox>& boxes)
+    {
+        clear();
+        boxes_ = boxes;
+        items_.resize(boxes_.size());
+        for (size_t i = 0; i < items_.size(); i++)
+            items_[i] = i;
+        if (!items_.empty())
+            build_node(0, items_.size());
+    }
+
+    size_t BoundingVolumeHierarchy::build_node(size_t begin, size_t end)
+    {
+        size_t id = nodes_.size();
+        nodes_.push_back(Node());
+        BoundingBox box, centers;
+        for (size_t i = begin; i < end; i++)
+        {
+            box.expand(boxes_[items_[i]]);
+            centers.expand(boxes_[items_[i]].center());
+        }
+        nodes_[id].box = box;
+        if (end - begin <= LEAF_SIZE)
+        {
+            nodes_[id].first = begin;
+            nodes_[id].count = end - begin;
+            return id;
+        }
+
+        // 沿中心点分布最广的方向取中位数划分
+        Point extent = centers.upper - centers.lower;
+        int axis = 0;
+        if (extent.y > extent[axis])
+            axis = 1;
+        if (extent.z > extent[axis])
+            axis = 2;
+        size_t mid = (begin + end) / 2;
+        nth_element(items_.begin() + begin, items_.begin() + mid, items_.begin() + end,
+                    [&](size_t a, size_t b) { return boxes_[a].center()[axis] < boxes_[b].center()[axis]; });
+
+        build_node(begin, mid);
+        size_t right = build_node(mid, end);
+        nodes_[id].first = right;
+        nodes_[id].count = 0;
+        return id;
+    }
+
+    void BoundingVolumeHierarchy::query(const BoundingBox& box, vector<size_t>& out) const
+    {
+        out.clear();
+        if (nodes_.empty())
+            return;
+        size_t stack[64];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node& node = nodes_[stack[--top]];
+            if (!node.box.overlaps(box))
+                continue;
+            if (node.count > 0)
+            {
+                for (size_t i = node.first; i < node.first + node.count; i++)
+                {
+                    if (boxes_[items_[i]].overlaps(box))
+                        out.push_back(items_[i]);
+                }
+            }
+            else
+            {
+                // 左孩子紧跟在父节点之后
+                size_t self = &node - nodes_.data();
+                stack[top++] = node.first;
+                stack[top++] = self + 1;
+            }
+        }
+        sort(out.begin(), out.end());
+    }
+
+    void BoundingVolumeHierarchy::query_segment(const Point& pnt1, const Point& pnt2, double margin, vector<size_t>& out) const
+    {
+        BoundingBox box(pnt1, pnt2);
+        box.inflate(margin);
+        query(box, out);
+    }
+
+    void BoundingVolumeHierarchy::query_point(const Point& p, vector<size_t>& out) const
+    {
+        query(BoundingBox::vertical_column(p), out);
+    }
+}
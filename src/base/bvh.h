@@ -0,0 +1,94 @@
+#pragma once
+#include "base/point.h"
+#include <vector>
+#include <limits>
+
+namespace ewd
+{
+    /**
+     * @brief 轴对齐包围盒
+     *
+     */
+    class BoundingBox
+    {
+    public:
+        Point lower, upper;
+
+        BoundingBox();
+        BoundingBox(const Point& p1, const Point& p2);
+
+        bool empty() const;
+        Point center() const;
+        void expand(const Point& p);
+        void expand(const BoundingBox& b);
+        void inflate(double margin);
+        bool overlaps(const BoundingBox& b) const;
+        bool contains(const Point& p) const;
+
+        /**
+         * @brief 竖直方向无界的包围盒，用于只关心水平位置的点查询
+         *
+         * @param p 点
+         * @return BoundingBox
+         */
+        static BoundingBox vertical_column(const Point& p);
+    };
+
+    /**
+     * @brief 包围盒层次树（BVH）
+     * 一次性建立在若干包围盒上，查询与给定包围盒相交的所有对象编号
+     */
+    class BoundingVolumeHierarchy
+    {
+    public:
+        BoundingVolumeHierarchy() {}
+        ~BoundingVolumeHierarchy() {}
+
+        void build(const std::vector<BoundingBox>& boxes);
+        void clear();
+        size_t size() const { return boxes_.size(); }
+        bool empty() const { return boxes_.empty(); }
+        const BoundingBox& box(size_t i) const { return boxes_[i]; }
+
+        /**
+         * @brief 查询与box相交的对象
+         *
+         * @param box 查询包围盒
+         * @param out 输出对象编号，升序排列
+         */
+        void query(const BoundingBox& box, std::vector<size_t>& out) const;
+
+        /**
+         * @brief 查询与线段pnt1-pnt2的包围盒（外扩margin）相交的对象
+         *
+         * @param pnt1 线段起点
+         * @param pnt2 线段终点
+         * @param margin 外扩量
+         * @param out 输出对象编号，升序排列
+         */
+        void query_segment(const Point& pnt1, const Point& pnt2, double margin, std::vector<size_t>& out) const;
+
+        /**
+         * @brief 查询水平位置包含p的对象（不考虑竖直方向）
+         *
+         * @param p 点
+         * @param out 输出对象编号，升序排列
+         */
+        void query_point(const Point& p, std::vector<size_t>& out) const;
+
+    private:
+        struct Node
+        {
+            BoundingBox box;
+            size_t first;   // 叶节点：items_中的起始位置；内部节点：右孩子编号
+            size_t count;   // 叶节点中的对象数目，内部节点为0
+        };
+        static const size_t LEAF_SIZE = 4;
+
+        std::vector<BoundingBox> boxes_;
+        std::vector<size_t> items_;
+        std::vector<Node> nodes_;
+
+        size_t build_node(size_t begin, size_t end);
+    };
+}
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 using namespace std;
 
 namespace ewd
@@ -13,6 +14,7 @@ namespace ewd
 	{
 		num_vertex_ = num_vertex;
 		adj_list_.resize(num_vertex_);
+		version_++;
 	}
 
 	EdgeIndex Graph::add_edge(VertexIndex i, VertexIndex j, double weight)
@@ -24,6 +26,7 @@ namespace ewd
 		adj_list_[i].push_back(num_edge_);
 		adj_list_[j].push_back(num_edge_);
 		num_edge_++;
+		version_++;
 		return num_edge_ - 1;
 	}
 
@@ -41,27 +44,19 @@ namespace ewd
 
 	EdgeIndex Graph::find_edge(const Edge &e) const
 	{
-		// for (EdgeIndex k = 0; k < edges_.size(); k++)
-		// {
-		// 	if (edges_[k].first == e.first && edges_[k].second == e.second)
-		// 		return k;
-		// 	else if (edges_[k].first == e.second && edges_[k].second == e.first)
-		// 		return k;
-		// }
-		for(EdgeIndex k:adj_list_[e.first])
-		{
-			if (edges_[k].first == e.first && edges_[k].second == e.second)
-				return k;
-			else if (edges_[k].first == e.second && edges_[k].second == e.first)
-				return k;
-		}
-		return edges_.size();
+		return find_edge(e.first, e.second);
 	}
 
 	EdgeIndex Graph::find_edge(VertexIndex i, VertexIndex j) const
 	{
-		for (EdgeIndex k = 0; k < edges_.size(); k++)
+		if (i >= adj_list_.size() || j >= adj_list_.size())
+			return edges_.size();
+		// 邻接表按边编号升序，扫描度数较小的一端，平行边中返回编号最小的
+		const vecIndex &adj = adj_list_[i].size() <= adj_list_[j].size() ? adj_list_[i] : adj_list_[j];
+		for (EdgeIndex k : adj)
 		{
+			if (is_removed(k))
+				continue;
 			if (edges_[k].first == i && edges_[k].second == j)
 				return k;
 			else if (edges_[k].first == j && edges_[k].second == i)
@@ -78,6 +73,9 @@ namespace ewd
 		VertexIndex j = edges_[k].second;
 		adj_list_[i].erase(find(adj_list_[i].begin(), adj_list_[i].end(), k));
 		adj_list_[j].erase(find(adj_list_[j].begin(), adj_list_[j].end(), k));
+		// 已标记删除的边随编号一起前移
+		if (k < removed_.size())
+			removed_.erase(removed_.begin() + k);
 		for (size_t v = 0; v < num_vertex_; v++)
 		{
 			for (auto &l : adj_list_[v])
@@ -89,6 +87,64 @@ namespace ewd
 		edges_.erase(edges_.begin() + k);
 		weights_.erase(weights_.begin()+k);
 		num_edge_--;
+		version_++;
+	}
+
+	void Graph::mark_removed(EdgeIndex k)
+	{
+		if (k >= edges_.size())
+			return;
+		if (removed_.size() < edges_.size())
+			removed_.resize(edges_.size(), 0);
+		if (removed_[k])
+			return;
+		removed_[k] = 1;
+		version_++;
+	}
+
+	vecIndex Graph::compact_removed()
+	{
+		const size_t NONE = numeric_limits<size_t>::max();
+		vecIndex new_index(edges_.size());
+		size_t m = 0;
+		for (EdgeIndex k = 0; k < edges_.size(); k++)
+		{
+			if (is_removed(k))
+			{
+				new_index[k] = NONE;
+				continue;
+			}
+			new_index[k] = m;
+			edges_[m] = edges_[k];
+			weights_[m] = weights_[k];
+			m++;
+		}
+		removed_.clear();
+		if (m == edges_.size())
+			return new_index;
+		edges_.resize(m);
+		weights_.resize(m);
+		// 保留的边相对顺序不变，邻接表仍按编号升序
+		for (auto &adj : adj_list_)
+		{
+			size_t n = 0;
+			for (EdgeIndex k : adj)
+			{
+				if (new_index[k] != NONE)
+					adj[n++] = new_index[k];
+			}
+			adj.resize(n);
+		}
+		num_edge_ = m;
+		version_++;
+		return new_index;
+	}
+
+	vecIndex Graph::remove_edges(const vecIndex &ks)
+	{
+		for (EdgeIndex k : ks)
+			mark_removed(k);
+		return compact_removed();
 	}
 
 	vecIndex Graph::GetAdjacentEdges(VertexIndex v) const
@@ -101,16 +157,63 @@ namespace ewd
 	std::map<size_t, double> Graph::reachable_neighbors(size_t v) const 
 	{
 		map<size_t, double> out;
-		if(v>= num_vertex_) return out;
-		for(size_t k:adj_list_[v])
+		for_each_neighbor(v, [&](VertexIndex u, EdgeIndex, double w) { out[u] = w; });
+		return out;
+	}
+
+	EdgeDirection direction_code(const Point &d, double REL_ERR)
+	{
+		const double EPS = 1e-9; // 其余分量相对边长可忽略时视为轴向
+		double n = d.norm();
+		if (n == 0.0 || n < REL_ERR)
+			return GENERAL;
+		if (fabs(d.y) <= EPS * n && fabs(d.z) <= EPS * n)
+			return d.x > 0 ? POS_X : NEG_X;
+		if (fabs(d.x) <= EPS * n && fabs(d.z) <= EPS * n)
+			return d.y > 0 ? POS_Y : NEG_Y;
+		if (fabs(d.x) <= EPS * n && fabs(d.y) <= EPS * n)
+			return d.z > 0 ? POS_Z : NEG_Z;
+		return GENERAL;
+	}
+
+	CsrGraph Graph::freeze() const
+	{
+		CsrGraph csr;
+		csr.num_edge_ = num_edge_;
+		csr.offsets_.assign(num_vertex_ + 1, 0);
+		for (VertexIndex v = 0; v < num_vertex_; v++)
 		{
-			size_t u = opposite(v,k);
-			if(out.find(u) == out.end() ||out[u] > weights_[k])
+			size_t deg = 0;
+			for (EdgeIndex k : adj_list_[v])
+				deg += !is_removed(k);
+			csr.offsets_[v + 1] = csr.offsets_[v] + deg;
+		}
+		size_t m = csr.offsets_[num_vertex_];
+		csr.neighbors_.resize(m);
+		csr.edge_ids_.resize(m);
+		csr.weights_.resize(m);
+		csr.direcs_.assign(m, GENERAL);
+
+		vector<pair<VertexIndex, EdgeIndex>> items;
+		for (VertexIndex v = 0; v < num_vertex_; v++)
+		{
+			items.clear();
+			for (EdgeIndex k : adj_list_[v])
+			{
+				if (!is_removed(k))
+					items.push_back(make_pair(opposite(v, k), k));
+			}
+			sort(items.begin(), items.end());
+			size_t i = csr.offsets_[v];
+			for (auto &it : items)
 			{
-				out[u] = weights_[k];
+				csr.neighbors_[i] = it.first;
+				csr.edge_ids_[i] = it.second;
+				csr.weights_[i] = weights_[it.second];
+				i++;
 			}
 		}
-		return out;
+		return csr;
 	}
 
 	bool Graph::connected() const
@@ -137,6 +240,8 @@ namespace ewd
 			q.pop();
 			for(const auto& k: adj_list_[v] )
 			{
+				if (is_removed(k))
+					continue;
 				VertexIndex j = opposite(v, k);
 				if(!visited[j])
 				{
@@ -159,16 +264,96 @@ namespace ewd
 		adj_list_.clear();
 	}
 	GeometricGraph::~GeometricGraph() {}
-	GeometricGraph::GeometricGraph(const GeometricGraph &g)
+	GeometricGraph::GeometricGraph(const GeometricGraph &g) : Graph(g)
+	{
+		vertex_ = g.vertex_;
+		direcs_ = g.direcs_;
+		REL_ERR_ = g.REL_ERR_;
+		ABS_ERR_ = g.ABS_ERR_;
+		WEAK_PARALLEL_ERR_ = g.WEAK_PARALLEL_ERR_;
+		cell_head_ = g.cell_head_;
+		cell_next_ = g.cell_next_;
+		cell_size_ = g.cell_size_;
+	}
+
+	GeometricGraph &GeometricGraph::operator=(const GeometricGraph &g)
 	{
-		num_vertex_ = g.num_vertex_;
-		num_edge_ = g.num_edge_;
+		Graph::operator=(g);
 		vertex_ = g.vertex_;
-		edges_ = g.edges_;
-		adj_list_ = g.adj_list_;
+		direcs_ = g.direcs_;
 		REL_ERR_ = g.REL_ERR_;
 		ABS_ERR_ = g.ABS_ERR_;
 		WEAK_PARALLEL_ERR_ = g.WEAK_PARALLEL_ERR_;
+		cell_head_ = g.cell_head_;
+		cell_next_ = g.cell_next_;
+		cell_size_ = g.cell_size_;
+		return *this;
+	}
+
+	int64_t GeometricGraph::cell_coord(double c) const
+	{
+		// 超出范围（含非有限值）的坐标归入边界格，仍能按距离判断
+		const double LIMIT = 4e18;
+		double q = floor(c / cell_size_);
+		return q > -LIMIT ? (q < LIMIT ? int64_t(q) : int64_t(LIMIT)) : -int64_t(LIMIT);
+	}
+
+	void GeometricGraph::index_vertex(VertexIndex v)
+	{
+		const Point &p = vertex_[v];
+		CellKey key{cell_coord(p.x), cell_coord(p.y), cell_coord(p.z)};
+		auto it = cell_head_.find(key);
+		cell_next_.push_back(it == cell_head_.end() ? numeric_limits<size_t>::max() : it->second);
+		cell_head_[key] = v;
+	}
+
+	void GeometricGraph::rebuild_vertex_index()
+	{
+		cell_head_.clear();
+		cell_next_.clear();
+		cell_next_.reserve(vertex_.size());
+		for (VertexIndex v = 0; v < vertex_.size(); v++)
+			index_vertex(v);
+	}
+
+	void GeometricGraph::set_ABS_ERR(double err)
+	{
+		ABS_ERR_ = err;
+		cell_size_ = err > 0.0 ? 2.0 * err : 1.0;
+		rebuild_vertex_index();
+	}
+
+	size_t GeometricGraph::find_vertex(const Point &p) const
+	{
+		size_t best = vertex_.size();
+		if (!(ABS_ERR_ > 0.0))
+			return best;
+		// 以p为心、ABS_ERR为半径的球在每个轴上至多跨两格
+		int64_t lo[3], hi[3];
+		const double c[3] = {p.x, p.y, p.z};
+		for (int a = 0; a < 3; a++)
+		{
+			lo[a] = cell_coord(c[a] - ABS_ERR_);
+			hi[a] = cell_coord(c[a] + ABS_ERR_);
+		}
+		for (int64_t x = lo[0]; x <= hi[0]; x++)
+		{
+			for (int64_t y = lo[1]; y <= hi[1]; y++)
+			{
+				for (int64_t z = lo[2]; z <= hi[2]; z++)
+				{
+					auto it = cell_head_.find(CellKey{x, y, z});
+					if (it == cell_head_.end())
+						continue;
+					for (size_t v = it->second; v != numeric_limits<size_t>::max(); v = cell_next_[v])
+					{
+						if (v < best && vertex_[v].distance(p) < ABS_ERR_)
+							best = v;
+					}
+				}
+			}
+		}
+		return best;
 	}
 
 
@@ -178,8 +363,10 @@ namespace ewd
 		if (i == vertex_.size())
 		{
 			vertex_.push_back(pnt);
+			index_vertex(i);
 			adj_list_.push_back(vector<size_t>());
 			num_vertex_++;
+			version_++;
 		}
 		return i;
 	}
@@ -188,8 +375,10 @@ namespace ewd
 	{
 		size_t n = vertex_.size();
 		vertex_.push_back(pnt);
+		index_vertex(n);
 		adj_list_.push_back(vector<size_t>());
 		num_vertex_++;
+		version_++;
 		return n;
 	}
 
@@ -201,7 +390,10 @@ namespace ewd
 			return edges_.size();
 		size_t k = find_edge(i, j);
 		if (k == edges_.size())
+		{
 			Graph::add_edge(i, j, weight);
+			direcs_.push_back(direction_code(vertex_[j] - vertex_[i], REL_ERR_));
+		}
 		return k;
 	}
 
@@ -263,12 +455,44 @@ namespace ewd
 		Edge e = {i, j};
 		edges_.push_back(e);
 		weights_.push_back(weight);
+		direcs_.push_back(direction_code(vertex_[j] - vertex_[i], REL_ERR_));
 		adj_list_[i].push_back(k);
 		adj_list_[j].push_back(k);
 		num_edge_++;
+		version_++;
 		return k;
 	}
 
+	void GeometricGraph::remove_edge(EdgeIndex k)
+	{
+		if (k >= edges_.size())
+			return;
+		Graph::remove_edge(k);
+		direcs_.erase(direcs_.begin() + k);
+	}
+
+	vecIndex GeometricGraph::compact_removed()
+	{
+		vecIndex new_index = Graph::compact_removed();
+		size_t m = 0;
+		for (EdgeIndex k = 0; k < new_index.size(); k++)
+		{
+			if (new_index[k] != numeric_limits<size_t>::max())
+				direcs_[m++] = direcs_[k];
+		}
+		direcs_.resize(m);
+		return new_index;
+	}
+
+	void GeometricGraph::set_REL_ERR(double err)
+	{
+		REL_ERR_ = err;
+		// 短边的编码与误差有关
+		for (EdgeIndex k = 0; k < edges_.size(); k++)
+			direcs_[k] = direction_code(vertex_[edges_[k].second] - vertex_[edges_[k].first], REL_ERR_);
+		version_++;
+	}
+
 	EdgeIndex GeometricGraph::find_edge(const Point &pnt1, const Point &pnt2) const
 	{
 		size_t i = find_vertex(pnt1);
@@ -301,6 +525,17 @@ namespace ewd
 		return false;
 	}
 
+	CsrGraph GeometricGraph::freeze() const
+	{
+		CsrGraph csr = Graph::freeze();
+		for (VertexIndex v = 0; v < num_vertex_; v++)
+		{
+			for (size_t i = csr.begin(v); i < csr.end(v); i++)
+				csr.direcs_[i] = edge_direction(csr.edge_ids_[i], v);
+		}
+		return csr;
+	}
+
 	VertexIndex GeometricGraph::BreakEdgeWithPnt(const Point &pnt, EdgeIndex k)
 	{
 		size_t n = add_vertex(pnt);
@@ -325,4 +560,56 @@ namespace ewd
 		return n;
 	}
 
+	vecIndex GeometricGraph::BreakEdgesWithPnts(const vector<Point> &pnts, const vecIndex &ks, bool new_pnt, vecIndex *edge_map)
+	{
+		size_t m = edges_.size();
+		vecIndex out(pnts.size());
+		vector<pair<double, size_t>> order; // (到first端的距离, 点序号)，按边分组
+		vecIndex group(pnts.size());
+		for (size_t i = 0; i < pnts.size(); i++)
+		{
+			out[i] = new_pnt ? add_vertex_simply(pnts[i]) : add_vertex(pnts[i]);
+			if (ks[i] < m)
+				order.push_back(make_pair(vertex_[edges_[ks[i]].first].distance(pnts[i]), i));
+		}
+		sort(order.begin(), order.end(), [&](const pair<double, size_t> &a, const pair<double, size_t> &b)
+		{
+			return ks[a.second] != ks[b.second] ? ks[a.second] < ks[b.second] : a < b;
+		});
+
+		for (size_t g0 = 0, g1; g0 < order.size(); g0 = g1)
+		{
+			EdgeIndex k = ks[order[g0].second];
+			for (g1 = g0; g1 < order.size() && ks[order[g1].second] == k; g1++)
+				;
+			size_t e0 = edges_[k].first, e1 = edges_[k].second;
+			vecIndex chain;
+			for (size_t t = g0; t < g1; t++)
+			{
+				size_t n = out[order[t].second];
+				if (new_pnt || (n != e0 && n != e1 && (chain.empty() || chain.back() != n)))
+					chain.push_back(n);
+			}
+			if (chain.empty())
+				continue;
+			mark_removed(k);
+			auto connect = [&](size_t i, size_t j)
+			{
+				if (new_pnt)
+					add_edge_simply(i, j, vertex_[i].distance(vertex_[j]));
+				else
+					add_edge(i, j, vertex_[i].distance(vertex_[j]));
+			};
+			connect(e0, chain.front());
+			for (size_t t = 0; t + 1 < chain.size(); t++)
+				connect(chain[t], chain[t + 1]);
+			connect(e1, chain.back());
+		}
+
+		vecIndex new_index = compact_removed();
+		if (edge_map != nullptr)
+			*edge_map = new_index;
+		return out;
+	}
+
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include <map>
 #include <tuple>
 #include <set>
+#include <unordered_map>
+#include <cstdint>
 
 namespace ewd
 {
@@ -13,6 +15,121 @@ namespace ewd
     using EdgeIndex = size_t;
     using Edge = std::pair<VertexIndex, VertexIndex>;
 
+    /**
+     * @brief 边的方向编码
+     * 沿坐标轴的边编码为六个轴向之一，其余（斜边、短于REL_ERR的边）为GENERAL
+     */
+    enum EdgeDirection : unsigned char
+    {
+        POS_X = 0,
+        NEG_X = 1,
+        POS_Y = 2,
+        NEG_Y = 3,
+        POS_Z = 4,
+        NEG_Z = 5,
+        GENERAL = 6
+    };
+
+    EdgeDirection direction_code(const Point &d, double REL_ERR = 0.0);
+
+    /**
+     * @brief 反方向的编码
+     */
+    inline EdgeDirection reversed(EdgeDirection d)
+    {
+        return d == GENERAL ? GENERAL : EdgeDirection(d ^ 1);
+    }
+
+    /**
+     * @brief 两个方向是否共线（同向或反向），GENERAL无法判断时返回false
+     */
+    inline bool same_axis(EdgeDirection d1, EdgeDirection d2)
+    {
+        return d1 != GENERAL && (d1 >> 1) == (d2 >> 1);
+    }
+
+    /**
+     * @brief 冻结的图，压缩稀疏行（CSR）格式
+     * 顶点v的邻接项为[begin(v), end(v))，按邻居编号、边编号升序，
+     * 每项记录邻居、边编号、权重和由v指向邻居的方向编码。
+     * 由Graph::freeze()生成，之后原图的修改不影响已冻结的图。
+     */
+    class CsrGraph
+    {
+    public:
+        CsrGraph() : offsets_(1, 0) {}
+
+        size_t num_vertex() const { return offsets_.size() - 1; }
+        size_t num_edge() const { return num_edge_; }
+
+        size_t begin(VertexIndex v) const { return offsets_[v]; }
+        size_t end(VertexIndex v) const { return offsets_[v + 1]; }
+        size_t degree(VertexIndex v) const { return offsets_[v + 1] - offsets_[v]; }
+
+        VertexIndex neighbor(size_t i) const { return neighbors_[i]; }
+        EdgeIndex edge_id(size_t i) const { return edge_ids_[i]; }
+        double weight(size_t i) const { return weights_[i]; }
+        EdgeDirection direction(size_t i) const { return direcs_[i]; }
+
+        /**
+         * @brief 遍历v的邻居，平行边只取权重最小的一条，不分配内存
+         *
+         * @param v 顶点
+         * @param f 回调f(i, w)，i为该邻居权重最小（相同时编号最小）的邻接项，w为其权重
+         */
+        template <typename F>
+        void for_each_neighbor(VertexIndex v, F &&f) const
+        {
+            for (size_t i = offsets_[v], end = offsets_[v + 1]; i < end;)
+            {
+                size_t best = i;
+                VertexIndex u = neighbors_[i];
+                for (i++; i < end && neighbors_[i] == u; i++)
+                {
+                    if (weights_[i] < weights_[best])
+                        best = i;
+                }
+                f(best, weights_[best]);
+            }
+        }
+
+    private:
+        size_t num_edge_ = 0;
+        vecIndex offsets_;
+        vecIndex neighbors_;
+        vecIndex edge_ids_;
+        vecDouble weights_;
+        std::vector<EdgeDirection> direcs_;
+
+        friend class Graph;
+        friend class GeometricGraph;
+        friend class GridGraph;
+    };
+
+    /**
+     * @brief 带坐标的图的只读接口，最少弯折最短路与分解求解只依赖此接口
+     * 由GeometricGraph（显式存储）与GridGraph（隐式网格）实现。
+     */
+    class SpatialGraph
+    {
+    public:
+        virtual ~SpatialGraph() {}
+
+        virtual size_t num_vertex() const = 0;
+        virtual size_t num_edge() const = 0;
+        virtual size_t version() const = 0; // 每次修改递增，用于判断冻结的图是否过期
+        virtual Point vertex(VertexIndex v) const = 0;
+        virtual Edge edge(EdgeIndex k) const = 0;
+        virtual double weight(EdgeIndex k) const = 0;
+        virtual double REL_ERR() const = 0;
+        virtual double WEAK_PARALLEL_ERR() const = 0;
+
+        /**
+         * @brief 生成CSR视图，附带各邻接项的方向编码
+         */
+        virtual CsrGraph freeze() const = 0;
+    };
+
     class EssentialGraph
     {
     protected:
@@ -20,14 +137,27 @@ namespace ewd
         size_t num_edge_ = 0;
         std::vector<Edge> edges_;
         vecDouble weights_;
+        size_t version_ = 0;
 
     public:
         EssentialGraph() : num_vertex_(0), num_edge_(0) {}
-        EssentialGraph(const EssentialGraph &g) : num_vertex_(g.num_vertex_),num_edge_(g.num_edge_), edges_(g.edges_){};
+        // 复制（构造或赋值）得到的图的版本号大于源图和自身原有的版本号，
+        // 因此绑定在目标图上的求解器总会重新冻结
+        EssentialGraph(const EssentialGraph &g) : num_vertex_(g.num_vertex_),num_edge_(g.num_edge_), edges_(g.edges_), weights_(g.weights_), version_(g.version_ + 1){};
+        EssentialGraph &operator=(const EssentialGraph &g)
+        {
+            num_vertex_ = g.num_vertex_;
+            num_edge_ = g.num_edge_;
+            edges_ = g.edges_;
+            weights_ = g.weights_;
+            version_ = (version_ > g.version_ ? version_ : g.version_) + 1;
+            return *this;
+        }
         ~EssentialGraph() {}
 
         size_t num_vertex() const { return num_vertex_; }
         size_t num_edge() const { return num_edge_; }
+        size_t version() const { return version_; } // 每次修改递增，用于判断冻结的图是否过期
         virtual size_t add_edge(size_t v1, size_t v2, double weight) = 0;
 
         virtual EdgeIndex find_edge(VertexIndex v1, VertexIndex v2) const = 0;
@@ -39,7 +169,8 @@ namespace ewd
         virtual void remove_edge(EdgeIndex i) = 0;
 
         Edge edge(EdgeIndex k) const { return edges_[k]; }
-        void set_edge_weight(EdgeIndex k, double w) {weights_[k] = w;}
+        void set_edge_weight(EdgeIndex k, double w) {weights_[k] = w; version_++;}
+        void set_edge_weights(const vecDouble& w) {weights_ = w; version_++;}
         double weight(EdgeIndex k) const { return weights_[k];}
         double total_weight(const std::vector<EdgeIndex>& c) const 
         {
@@ -72,42 +203,149 @@ namespace ewd
     {
     protected:
         std::vector<std::vector<EdgeIndex>> adj_list_;
+        std::vector<char> removed_; // 已标记删除、等待压缩的边，按需扩展
 
     public:
         Graph() : EssentialGraph() {}
         Graph(const Graph &g) : EssentialGraph(g),
-                                adj_list_(g.adj_list_) {}
+                                adj_list_(g.adj_list_), removed_(g.removed_) {}
+        Graph &operator=(const Graph &g)
+        {
+            EssentialGraph::operator=(g);
+            adj_list_ = g.adj_list_;
+            removed_ = g.removed_;
+            return *this;
+        }
         ~Graph() {}
 
         void set_vertex_num(VertexIndex num_vertex);
         EdgeIndex add_edge(VertexIndex v1, VertexIndex v2, double weight=1.0) override;
+        /**
+         * @brief 查找连接两顶点的边，O(min(deg(i), deg(j)))
+         * @return EdgeIndex 边编号，不存在时为num_edge()
+         */
         EdgeIndex find_edge(const Edge &e) const;
         EdgeIndex find_edge(VertexIndex i, VertexIndex j) const;
         void remove_edge(EdgeIndex k);
+
+        /**
+         * @brief 标记删除边k，编号不变，compact_removed()时才真正删除
+         * 压缩前边仍在邻接表中，find_edge()、for_each_neighbor()、freeze()与连通性判断跳过已标记的边；
+         * GetAdjacentEdges()返回原始邻接表，包含已标记的边；首次标记时版本号递增，已冻结的视图随之过期
+         */
+        void mark_removed(EdgeIndex k);
+        bool is_removed(EdgeIndex k) const { return k < removed_.size() && removed_[k]; }
+
+        /**
+         * @brief 一次线性扫描删除所有已标记的边，重写边数组与邻接表
+         *
+         * @return vecIndex 旧编号到新编号的映射，被删除的边为size_t最大值
+         */
+        virtual vecIndex compact_removed();
+
+        /**
+         * @brief 批量删除边，O(V + E)，代替逐条调用remove_edge()
+         *
+         * @param ks 要删除的边，可重复
+         * @return vecIndex 旧编号到新编号的映射，被删除的边为size_t最大值
+         */
+        vecIndex remove_edges(const vecIndex &ks);
+
         vecIndex GetAdjacentEdges(VertexIndex i) const override;
         std::map<size_t, double> reachable_neighbors(size_t v) const override;
+
+        /**
+         * @brief 遍历v的邻居，平行边只取权重最小的一条，不分配内存
+         * 按邻接表顺序访问；平行边的去重需逐对比较，适用于度数较小的图
+         *
+         * @param v 顶点
+         * @param f 回调f(u, k, w)，u为邻居，k为权重最小（相同时最先加入）的边，w为其权重
+         */
+        template <typename F>
+        void for_each_neighbor(VertexIndex v, F &&f) const
+        {
+            if (v >= num_vertex_)
+                return;
+            const std::vector<EdgeIndex> &adj = adj_list_[v];
+            for (size_t i = 0; i < adj.size(); i++)
+            {
+                if (is_removed(adj[i]))
+                    continue;
+                VertexIndex u = opposite(v, adj[i]);
+                bool seen = false;
+                for (size_t j = 0; j < i && !seen; j++)
+                    seen = !is_removed(adj[j]) && opposite(v, adj[j]) == u;
+                if (seen)
+                    continue;
+                EdgeIndex best = adj[i];
+                for (size_t j = i + 1; j < adj.size(); j++)
+                {
+                    if (!is_removed(adj[j]) && opposite(v, adj[j]) == u && weights_[adj[j]] < weights_[best])
+                        best = adj[j];
+                }
+                f(u, best, weights_[best]);
+            }
+        }
+
         bool connected() const;
         bool check_connected(std::set<VertexIndex> &pnts) const;
+
+        /**
+         * @brief 生成当前图的CSR视图，方向编码均为GENERAL
+         * 跳过已标记删除的边，边编号与原图相同
+         *
+         * @return CsrGraph
+         */
+        virtual CsrGraph freeze() const;
     };
 
-    class GeometricGraph : public Graph
+    class GeometricGraph : public Graph, public SpatialGraph
     {
     protected:
         std::vector<Point> vertex_;
+        std::vector<EdgeDirection> direcs_; // 各边由first指向second的方向编码
         double REL_ERR_ = 0.001;
         double ABS_ERR_ = 0.001;
         double WEAK_PARALLEL_ERR_ = 0.3;
+
+        // 顶点的空间哈希：边长为2*ABS_ERR_的均匀网格，同格的顶点以cell_next_串成链表
+        struct CellKey
+        {
+            int64_t x, y, z;
+            bool operator==(const CellKey &r) const { return x == r.x && y == r.y && z == r.z; }
+        };
+        struct CellKeyHash
+        {
+            size_t operator()(const CellKey &k) const
+            {
+                return size_t((uint64_t(k.x) * 73856093u) ^ (uint64_t(k.y) * 19349663u) ^ (uint64_t(k.z) * 83492791u));
+            }
+        };
+        std::unordered_map<CellKey, VertexIndex, CellKeyHash> cell_head_;
+        vecIndex cell_next_;
+        double cell_size_ = 0.002;
+        int64_t cell_coord(double c) const;
+        void index_vertex(VertexIndex v);
+        void rebuild_vertex_index();
     public:
         GeometricGraph();
         GeometricGraph(const GeometricGraph &g);
+        GeometricGraph &operator=(const GeometricGraph &g);
         ~GeometricGraph();
 
-        double REL_ERR() const { return REL_ERR_; }
+        // 与EssentialGraph的同名函数结果相同，经SpatialGraph调用时为虚函数
+        size_t num_vertex() const override { return num_vertex_; }
+        size_t num_edge() const override { return num_edge_; }
+        size_t version() const override { return version_; }
+        Edge edge(EdgeIndex k) const override { return edges_[k]; }
+        double weight(EdgeIndex k) const override { return weights_[k]; }
+
+        double REL_ERR() const override { return REL_ERR_; }
         double ABS_ERR() const { return ABS_ERR_; }
-        double WEAK_PARALLEL_ERR() const { return WEAK_PARALLEL_ERR_; }
+        double WEAK_PARALLEL_ERR() const override { return WEAK_PARALLEL_ERR_; }
 
-        void set_REL_ERR(double err) { REL_ERR_ = err; }
-        void set_ABS_ERR(double err) { ABS_ERR_ = err; }
+        void set_REL_ERR(double err);
+        void set_ABS_ERR(double err); // 同时按新的误差重建顶点的空间哈希
         void set_WEAK_PARALLEL_ERR(double err) { WEAK_PARALLEL_ERR_ = err; }
 
         VertexIndex add_vertex(const Point &pnt);
@@ -115,26 +353,55 @@ namespace ewd
         EdgeIndex add_edge(VertexIndex i, VertexIndex j, double weight = 1.0) override;
         void add_edge_safely(VertexIndex i, VertexIndex j);
         EdgeIndex add_edge_simply(VertexIndex i, VertexIndex j, double weight = 1.0);
+        void remove_edge(EdgeIndex k) override;
+        vecIndex compact_removed() override;
 
         EdgeIndex find_edge(const Edge &e) const { return Graph::find_edge(e); }
         EdgeIndex find_edge(VertexIndex i, VertexIndex j) const { return Graph::find_edge(i, j); }
         EdgeIndex find_edge(const Point &pnt1, const Point &pnt2) const;
         Point get_edge_direc(EdgeIndex k, bool normalized = true) const;
 
+        /**
+         * @brief 边k由from指向另一端的方向编码
+         *
+         * @param k 边
+         * @param from 边的一端
+         * @return EdgeDirection
+         */
+        EdgeDirection edge_direction(EdgeIndex k, VertexIndex from) const
+        {
+            return edges_[k].first == from ? direcs_[k] : reversed(direcs_[k]);
+        }
+
         bool IsPntLieInEdge(const Point &pnt, EdgeIndex k) const;
         VertexIndex BreakEdgeWithPnt(const Point &pnt, EdgeIndex k);
         VertexIndex BreakEdgeWithNewPnt(const Point &pnt, EdgeIndex k);
 
-        size_t find_vertex(const Point &p) const
-        {
-            for (size_t i = 0; i < vertex_.size(); i++)
-            {
-                if (vertex_[i].distance(p) < ABS_ERR_)
-                    return i;
-            }
-            return vertex_.size();
-        }
-        Point vertex(size_t v) const 
+        /**
+         * @brief 批量以点打断边，被打断的边最后一次压缩删除
+         * 同一条边上的多个点按到first端的距离排序后依次连接。
+         *
+         * @param pnts 打断点
+         * @param ks 各点所在的边，为打断前的编号
+         * @param new_pnt 为真时同BreakEdgeWithNewPnt()，总是新建顶点、不检查重复的边；否则同BreakEdgeWithPnt()
+         * @param edge_map 非空时输出打断前编号到新编号的映射，被打断的边为size_t最大值
+         * @return vecIndex 各点对应的顶点
+         */
+        vecIndex BreakEdgesWithPnts(const std::vector<Point> &pnts, const vecIndex &ks, bool new_pnt = false, vecIndex *edge_map = nullptr);
+
+        /**
+         * @brief 生成当前图的CSR视图，附带各邻接项的方向编码
+         *
+         * @return CsrGraph
+         */
+        CsrGraph freeze() const override;
+
+        /**
+         * @brief 与p的距离小于ABS_ERR的编号最小的顶点，经空间哈希O(1)查找
+         * @return size_t 顶点编号，不存在时为num_vertex()
+         */
+        size_t find_vertex(const Point &p) const;
+        Point vertex(size_t v) const override
         { 
             return vertex_[v]; 
         }
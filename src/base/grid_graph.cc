@@ -0,0 +1,292 @@
+#include "base/grid_graph.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+namespace ewd
+{
+    static size_t popcount64(uint64_t x)
+    {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return size_t((x * 0x0101010101010101ull) >> 56);
+    }
+
+    GridGraph::GridGraph(const vecDouble &xs, const vecDouble &ys, const vecDouble &zs)
+        : xs_(xs), ys_(ys), zs_(zs)
+    {
+        size_t words = (num_grid_vertex() + 63) / 64;
+        for (int a = 0; a < 3; a++)
+            passable_[a].assign(words, 0);
+        build_edges();
+    }
+
+    size_t GridGraph::stride(int axis) const
+    {
+        return axis == 0 ? 1 : axis == 1 ? xs_.size() : xs_.size() * ys_.size();
+    }
+
+    size_t GridGraph::axis_size(int axis) const
+    {
+        return axis == 0 ? xs_.size() : axis == 1 ? ys_.size() : zs_.size();
+    }
+
+    size_t GridGraph::axis_coord(int axis, VertexIndex v) const
+    {
+        return (v / stride(axis)) % axis_size(axis);
+    }
+
+    void GridGraph::set_passable(int axis, VertexIndex v, bool b)
+    {
+        if (v >= num_grid_vertex() || axis_coord(axis, v) + 1 >= axis_size(axis))
+            return;
+        uint64_t bit = uint64_t(1) << (v & 63);
+        if (b)
+            passable_[axis][v >> 6] |= bit;
+        else
+            passable_[axis][v >> 6] &= ~bit;
+        version_++;
+    }
+
+    void GridGraph::build_edges()
+    {
+        size_t old_grid = weights_.size() - extra_edges_.size();
+        for (int a = 0; a < 3; a++)
+        {
+            const vector<uint64_t> &bits = passable_[a];
+            rank_[a].resize(bits.size() + 1);
+            size_t count = 0;
+            for (size_t w = 0; w < bits.size(); w++)
+            {
+                rank_[a][w] = uint32_t(count);
+                count += popcount64(bits[w]);
+            }
+            rank_[a][bits.size()] = uint32_t(count);
+            axis_begin_[a + 1] = axis_begin_[a] + count;
+        }
+        vecDouble weights(axis_begin_[3], 1.0);
+        weights.insert(weights.end(), weights_.begin() + old_grid, weights_.end());
+        weights_.swap(weights);
+        version_++;
+    }
+
+    EdgeIndex GridGraph::grid_edge_id(int axis, VertexIndex v) const
+    {
+        uint64_t below = passable_[axis][v >> 6] & ((uint64_t(1) << (v & 63)) - 1);
+        return axis_begin_[axis] + rank_[axis][v >> 6] + popcount64(below);
+    }
+
+    VertexIndex GridGraph::add_vertex_simply(const Point &pnt)
+    {
+        extra_vertex_.push_back(pnt);
+        version_++;
+        return num_vertex() - 1;
+    }
+
+    EdgeIndex GridGraph::add_edge(VertexIndex i, VertexIndex j, double weight)
+    {
+        extra_adj_[i].push_back(extra_edges_.size());
+        if (j != i)
+            extra_adj_[j].push_back(extra_edges_.size());
+        extra_edges_.push_back(make_pair(i, j));
+        weights_.push_back(weight);
+        version_++;
+        return weights_.size() - 1;
+    }
+
+    Point GridGraph::vertex(VertexIndex v) const
+    {
+        size_t G = num_grid_vertex();
+        if (v >= G)
+            return extra_vertex_[v - G];
+        size_t nx = xs_.size(), ny = ys_.size();
+        return Point(xs_[v % nx], ys_[(v / nx) % ny], zs_[v / (nx * ny)]);
+    }
+
+    Edge GridGraph::edge(EdgeIndex k) const
+    {
+        if (k >= axis_begin_[3])
+            return extra_edges_[k - axis_begin_[3]];
+        int a = k < axis_begin_[1] ? 0 : k < axis_begin_[2] ? 1 : 2;
+        // 按前缀计数找到第r个置位所在的字，再在字内逐位去除
+        size_t r = k - axis_begin_[a];
+        size_t w = upper_bound(rank_[a].begin(), rank_[a].end(), uint32_t(r)) - rank_[a].begin() - 1;
+        uint64_t x = passable_[a][w];
+        for (r -= rank_[a][w]; r > 0; r--)
+            x &= x - 1;
+        VertexIndex v = w * 64 + popcount64((x & (~x + 1)) - 1);
+        return make_pair(v, v + stride(a));
+    }
+
+    EdgeIndex GridGraph::find_edge(VertexIndex i, VertexIndex j) const
+    {
+        size_t G = num_grid_vertex();
+        if (i < G && j < G)
+        {
+            VertexIndex lo = min(i, j), hi = max(i, j);
+            for (int a = 0; a < 3; a++)
+            {
+                if (hi - lo == stride(a) && axis_coord(a, lo) + 1 < axis_size(a) && passable(a, lo))
+                    return grid_edge_id(a, lo);
+            }
+        }
+        auto it = extra_adj_.find(i);
+        if (it == extra_adj_.end())
+            return num_edge();
+        for (size_t o : it->second)
+        {
+            const Edge &e = extra_edges_[o];
+            if ((e.first == i && e.second == j) || (e.first == j && e.second == i))
+                return axis_begin_[3] + o;
+        }
+        return num_edge();
+    }
+
+    size_t GridGraph::find_coord(const vecDouble &cs, double c) const
+    {
+        return lower_bound(cs.begin(), cs.end(), c - ABS_ERR_) - cs.begin();
+    }
+
+    size_t GridGraph::find_vertex(const Point &p) const
+    {
+        // 顶点编号随k、j、i递增，第一个命中的网格顶点即编号最小
+        for (size_t k = find_coord(zs_, p.z); k < zs_.size() && zs_[k] < p.z + ABS_ERR_; k++)
+        {
+            for (size_t j = find_coord(ys_, p.y); j < ys_.size() && ys_[j] < p.y + ABS_ERR_; j++)
+            {
+                for (size_t i = find_coord(xs_, p.x); i < xs_.size() && xs_[i] < p.x + ABS_ERR_; i++)
+                {
+                    if (Point(xs_[i], ys_[j], zs_[k]).distance(p) < ABS_ERR_)
+                        return grid_index(i, j, k);
+                }
+            }
+        }
+        for (size_t o = 0; o < extra_vertex_.size(); o++)
+        {
+            if (extra_vertex_[o].distance(p) < ABS_ERR_)
+                return num_grid_vertex() + o;
+        }
+        return num_vertex();
+    }
+
+    CsrGraph GridGraph::freeze() const
+    {
+        size_t G = num_grid_vertex(), n = num_vertex();
+        size_t E = axis_begin_[3];
+
+        // 附加边按端点分组
+        vecIndex extra_offsets(n + 1, 0);
+        for (const Edge &e : extra_edges_)
+        {
+            extra_offsets[e.first + 1]++;
+            extra_offsets[e.second + 1]++;
+        }
+        for (size_t v = 0; v < n; v++)
+            extra_offsets[v + 1] += extra_offsets[v];
+        vecIndex extra_adj(extra_offsets[n]);
+        {
+            vecIndex fill(extra_offsets.begin(), extra_offsets.end() - 1);
+            for (size_t o = 0; o < extra_edges_.size(); o++)
+            {
+                extra_adj[fill[extra_edges_[o].first]++] = o;
+                extra_adj[fill[extra_edges_[o].second]++] = o;
+            }
+        }
+
+        // 网格邻接项：负向z、y、x，再正向x、y、z，邻居编号即为升序
+        const vecDouble *coords[3] = {&xs_, &ys_, &zs_};
+        size_t c[3] = {0, 0, 0}; // 当前网格顶点的坐标序号
+        auto axis_direc = [&](int a, size_t lo, bool positive)
+        {
+            double len = (*coords[a])[lo + 1] - (*coords[a])[lo];
+            if (len == 0.0 || len < REL_ERR_)
+                return GENERAL;
+            return EdgeDirection(2 * a + (positive ? 0 : 1));
+        };
+        auto for_each_grid_adj = [&](VertexIndex v, auto &&f)
+        {
+            for (int a = 2; a >= 0; a--)
+            {
+                if (c[a] > 0 && passable(a, v - stride(a)))
+                    f(v - stride(a), grid_edge_id(a, v - stride(a)), axis_direc(a, c[a] - 1, false));
+            }
+            for (int a = 0; a < 3; a++)
+            {
+                if (c[a] + 1 < axis_size(a) && passable(a, v))
+                    f(v + stride(a), grid_edge_id(a, v), axis_direc(a, c[a], true));
+            }
+        };
+        auto next_grid_vertex = [&]()
+        {
+            for (int a = 0; a < 3 && ++c[a] == axis_size(a); a++)
+                c[a] = 0;
+        };
+
+        CsrGraph csr;
+        csr.num_edge_ = num_edge();
+        csr.offsets_.assign(n + 1, 0);
+        for (VertexIndex v = 0; v < n; v++)
+        {
+            size_t deg = extra_offsets[v + 1] - extra_offsets[v];
+            if (v < G)
+            {
+                for_each_grid_adj(v, [&](VertexIndex, EdgeIndex, EdgeDirection) { deg++; });
+                next_grid_vertex();
+            }
+            csr.offsets_[v + 1] = csr.offsets_[v] + deg;
+        }
+        size_t m = csr.offsets_[n];
+        csr.neighbors_.resize(m);
+        csr.edge_ids_.resize(m);
+        csr.weights_.resize(m);
+        csr.direcs_.resize(m);
+
+        vector<tuple<VertexIndex, EdgeIndex, EdgeDirection>> items;
+        for (VertexIndex v = 0; v < n; v++)
+        {
+            items.clear();
+            if (v < G)
+            {
+                for_each_grid_adj(v, [&](VertexIndex u, EdgeIndex k, EdgeDirection d) { items.emplace_back(u, k, d); });
+                next_grid_vertex();
+            }
+            if (extra_offsets[v] < extra_offsets[v + 1])
+            {
+                Point pv = vertex(v);
+                for (size_t t = extra_offsets[v]; t < extra_offsets[v + 1]; t++)
+                {
+                    const Edge &e = extra_edges_[extra_adj[t]];
+                    VertexIndex u = e.first == v ? e.second : e.first;
+                    items.emplace_back(u, E + extra_adj[t], direction_code(vertex(u) - pv, REL_ERR_));
+                }
+                sort(items.begin(), items.end());
+            }
+            size_t i = csr.offsets_[v];
+            for (auto &it : items)
+            {
+                csr.neighbors_[i] = get<0>(it);
+                csr.edge_ids_[i] = get<1>(it);
+                csr.weights_[i] = weights_[get<1>(it)];
+                csr.direcs_[i] = get<2>(it);
+                i++;
+            }
+        }
+        return csr;
+    }
+
+    size_t GridGraph::memory_bytes() const
+    {
+        size_t bytes = sizeof(*this);
+        bytes += (xs_.capacity() + ys_.capacity() + zs_.capacity()) * sizeof(double);
+        for (int a = 0; a < 3; a++)
+            bytes += passable_[a].capacity() * sizeof(uint64_t) + rank_[a].capacity() * sizeof(uint32_t);
+        bytes += extra_vertex_.capacity() * sizeof(Point);
+        bytes += extra_edges_.capacity() * sizeof(Edge);
+        for (auto &a : extra_adj_)
+            bytes += sizeof(a) + a.second.capacity() * sizeof(size_t);
+        bytes += weights_.capacity() * sizeof(double);
+        return bytes;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "base/graph.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ewd
+{
+    /**
+     * @brief 隐式存储的Hanan网格图
+     * 网格顶点由三组坐标隐式给出，编号为i + nx*(j + ny*k)；网格边不存端点，
+     * 每个轴向以一位记录顶点到其正向相邻顶点的边是否可通行。
+     * 可通行的网格边按x、y、z轴依次、轴内按低端顶点升序编号，权重紧凑存放。
+     * 不在网格上的顶点与边（如低于吊顶的设备及其连线）存放在附加部分，
+     * 顶点编号从num_grid_vertex()开始，边编号从num_grid_edge()开始。
+     */
+    class GridGraph : public SpatialGraph
+    {
+    public:
+        GridGraph() {}
+
+        /**
+         * @brief 建立所有网格边均不可通行的网格
+         *
+         * @param xs x坐标，升序
+         * @param ys y坐标，升序
+         * @param zs z坐标，升序
+         */
+        GridGraph(const vecDouble &xs, const vecDouble &ys, const vecDouble &zs);
+
+        size_t nx() const { return xs_.size(); }
+        size_t ny() const { return ys_.size(); }
+        size_t nz() const { return zs_.size(); }
+        size_t num_grid_vertex() const { return xs_.size() * ys_.size() * zs_.size(); }
+        size_t num_grid_edge() const { return axis_begin_[3]; }
+        VertexIndex grid_index(size_t i, size_t j, size_t k) const { return i + xs_.size() * (j + ys_.size() * k); }
+
+        /**
+         * @brief 设置网格顶点v到其axis正向相邻顶点的边是否可通行
+         * 之后须调用build_edges()重新编号
+         *
+         * @param axis 方向：0-x，1-y，2-z
+         * @param v 边的低端网格顶点
+         * @param b 是否可通行
+         */
+        void set_passable(int axis, VertexIndex v, bool b = true);
+        bool passable(int axis, VertexIndex v) const
+        {
+            return (passable_[axis][v >> 6] >> (v & 63)) & 1;
+        }
+
+        /**
+         * @brief 按可通行位给网格边编号，网格边的权重重置为1，附加边的权重保留
+         */
+        void build_edges();
+
+        VertexIndex add_vertex_simply(const Point &pnt); // 加入附加顶点，不查重
+        EdgeIndex add_edge(VertexIndex i, VertexIndex j, double weight = 1.0);
+
+        size_t num_vertex() const override { return num_grid_vertex() + extra_vertex_.size(); }
+        size_t num_edge() const override { return weights_.size(); }
+        size_t version() const override { return version_; }
+        Point vertex(VertexIndex v) const override;
+        Edge edge(EdgeIndex k) const override;
+        double weight(EdgeIndex k) const override { return weights_[k]; }
+        void set_edge_weight(EdgeIndex k, double w) { weights_[k] = w; version_++; }
+        void set_edge_weights(const vecDouble &w) { weights_ = w; version_++; }
+
+        double REL_ERR() const override { return REL_ERR_; }
+        double ABS_ERR() const { return ABS_ERR_; }
+        double WEAK_PARALLEL_ERR() const override { return WEAK_PARALLEL_ERR_; }
+        void set_REL_ERR(double err) { REL_ERR_ = err; version_++; }
+        void set_ABS_ERR(double err) { ABS_ERR_ = err; }
+        void set_WEAK_PARALLEL_ERR(double err) { WEAK_PARALLEL_ERR_ = err; }
+
+        /**
+         * @brief 查找连接两顶点的边，网格边O(1)，附加边按端点索引查找
+         * @return EdgeIndex 边编号，不存在时为num_edge()
+         */
+        EdgeIndex find_edge(VertexIndex i, VertexIndex j) const;
+
+        /**
+         * @brief 与p的距离小于ABS_ERR的编号最小的顶点，网格顶点按坐标二分查找
+         * @return size_t 顶点编号，不存在时为num_vertex()
+         */
+        size_t find_vertex(const Point &p) const;
+
+        /**
+         * @brief 生成CSR视图，邻接项的顺序与GeometricGraph::freeze()相同
+         *
+         * @return CsrGraph
+         */
+        CsrGraph freeze() const override;
+
+        /**
+         * @brief 图本身占用的字节数（不含CSR视图）
+         */
+        size_t memory_bytes() const;
+
+    private:
+        vecDouble xs_, ys_, zs_;
+        std::vector<uint64_t> passable_[3]; // 每轴每个网格顶点一位
+        std::vector<uint32_t> rank_[3];     // rank_[a][w]：passable_[a]前w个字中置位的个数
+        size_t axis_begin_[4] = {0, 0, 0, 0}; // 各轴第一条网格边的编号
+        std::vector<Point> extra_vertex_;
+        std::vector<Edge> extra_edges_;
+        std::unordered_map<VertexIndex, vecIndex> extra_adj_; // 各顶点的附加边在extra_edges_中的位置，只含有附加边的顶点
+        vecDouble weights_; // 网格边在前，附加边在后
+        size_t version_ = 0;
+        double REL_ERR_ = 0.001;
+        double ABS_ERR_ = 0.001;
+        double WEAK_PARALLEL_ERR_ = 0.3;
+
+        size_t stride(int axis) const;
+        size_t axis_coord(int axis, VertexIndex v) const;
+        size_t axis_size(int axis) const;
+        EdgeIndex grid_edge_id(int axis, VertexIndex v) const; // 须passable(axis, v)
+        size_t find_coord(const vecDouble &cs, double c) const;
+    };
+}
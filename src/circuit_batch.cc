@@ -0,0 +1,79 @@
+#include "circuit_batch.h"
+#include "decomposition_approach.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+namespace ewd
+{
+    void CircuitBatch::add_wall(const Wall &wl) { base_.add_wall(wl); }
+    void CircuitBatch::add_door(const Door &wd) { base_.add_door(wd); }
+    void CircuitBatch::set_PSB(const Device &dev) { base_.set_PSB(dev); }
+    void CircuitBatch::read_config(const Config &conf) { base_.read_config(conf); }
+
+    void CircuitBatch::add_circuit(const string &id, const vector<Device> &devices, const Config &conf)
+    {
+        ids_.push_back(id);
+        devices_.push_back(devices);
+        configs_.push_back(conf);
+    }
+
+    int CircuitBatch::solve()
+    {
+        int err = base_.preprocess();
+        base_.prepare_grid_lines();
+
+        results.clear();
+        results.resize(ids_.size());
+        size_t n = num_threads > 0 ? num_threads : thread::hardware_concurrency();
+        n = max<size_t>(1, min(n, ids_.size()));
+
+        atomic<size_t> next(0);
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < ids_.size(); i = next++)
+                solve_circuit(i);
+        };
+        vector<thread> pool;
+        for (size_t t = 1; t < n; t++)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &th : pool)
+            th.join();
+        return err;
+    }
+
+    void CircuitBatch::solve_circuit(size_t i)
+    {
+        CircuitResult &rslt = results[i];
+        rslt.id = ids_[i];
+        rslt.gc = base_;
+        GraphConstructor &gc = rslt.gc;
+
+        // 几何参数已用于预处理，回路配置只改变其余参数
+        Config conf = configs_[i];
+        conf.floor_height = base_.floor_height;
+        conf.offset_door = base_.offset_door;
+        gc.read_config(conf);
+        for (const Device &dev : devices_[i])
+            gc.add_device(dev);
+        gc.build_graph();
+
+        // 接线盒到各设备
+        DecompositionApproach da(gc.g);
+        da.num_threads = 1; // 回路之间已并行
+        da.PSB = gc.JB_index;
+        da.devices = gc.devices_indices;
+        da.solve(false);
+        rslt.obj = da.obj;
+
+        // 配电箱到接线盒
+        da.PSB = gc.PSB_index;
+        da.devices = {gc.JB_index};
+        da.bidirectional = bidirectional_home_run;
+        da.solve(false);
+        rslt.home_run_obj = da.obj;
+        rslt.paths = da.paths;
+    }
+}
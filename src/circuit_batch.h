@@ -0,0 +1,74 @@
+#pragma once
+#include "graph_constructor.h"
+#include "algorithms/mbsp.h"
+#include <string>
+#include <vector>
+
+namespace ewd
+{
+    /**
+     * @brief 单个回路的求解结果
+     *
+     */
+    struct CircuitResult
+    {
+        std::string id;
+        GraphConstructor gc;    // 该回路的图，路径中的顶点编号对应gc.g
+        std::vector<std::vector<size_t>> paths; // 接线盒到各设备的路径在前，配电箱到接线盒的路径在后
+        CostBend obj;           // 接线盒到各设备
+        CostBend home_run_obj;  // 配电箱到接线盒
+    };
+
+    /**
+     * @brief 同一楼层的多个回路批量求解
+     * 墙体、门窗预处理和基础网格线分析只做一次，各回路复制预处理结果后
+     * 加入各自的设备建图、求解，在多个线程上并行
+     */
+    class CircuitBatch
+    {
+    public:
+        size_t num_threads = 0;     // 0：使用硬件线程数
+        bool bidirectional_home_run = false; // 配电箱到接线盒按双向搜索求解
+        std::vector<CircuitResult> results;
+
+        CircuitBatch() {}
+        ~CircuitBatch() {}
+
+        void add_wall(const Wall &wl);
+        void add_door(const Door &wd);
+        void set_PSB(const Device &dev);
+
+        /**
+         * @brief 设置楼层配置
+         * 层高、门窗间距等几何参数对所有回路生效，单价等参数可被回路配置覆盖
+         * @param conf 配置
+         */
+        void read_config(const Config &conf);
+
+        /**
+         * @brief 添加回路
+         *
+         * @param id 回路编号
+         * @param devices 回路中的设备，需包含一个接线盒
+         * @param conf 回路配置，其中的几何参数被忽略
+         */
+        void add_circuit(const std::string &id, const std::vector<Device> &devices, const Config &conf);
+
+        size_t num_circuit() const { return ids_.size(); }
+
+        /**
+         * @brief 预处理并求解所有回路，结果按添加顺序存于results
+         *
+         * @return int 预处理的错误码
+         */
+        int solve();
+
+    private:
+        GraphConstructor base_;
+        std::vector<std::string> ids_;
+        std::vector<std::vector<Device>> devices_;
+        std::vector<Config> configs_;
+
+        void solve_circuit(size_t i);
+    };
+}
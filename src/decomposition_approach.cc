@@ -1,10 +1,51 @@
 #include "decomposition_approach.h"
 #include "algorithms/mst.h"
+#include "algorithms/path_tree_store.h"
+#include "algorithms/terminal_distances.h"
+#include "algorithms/steiner_tree.h"
 #include <numeric>
+#include <map>
+#include <set>
+#include <algorithm>
 using namespace std;
 using namespace ewd;
 
+// 路径的弯折数，与MinBendShortestPath的计数规则一致
+static int path_bends(const SpatialGraph &g, const vecIndex &path)
+{
+    double REL_ERR = g.REL_ERR();
+    int bends = 0;
+    for (size_t i = 1; i + 1 < path.size(); i++)
+    {
+        Point d0 = g.vertex(path[i]) - g.vertex(path[i - 1]);
+        Point d1 = g.vertex(path[i + 1]) - g.vertex(path[i]);
+        EdgeDirection c0 = direction_code(d0, REL_ERR), c1 = direction_code(d1, REL_ERR);
+        bool parallel = (c0 != GENERAL && c1 != GENERAL) ? same_axis(c0, c1)
+                                                         : d1.IsWeakParallel(d0, REL_ERR, g.WEAK_PARALLEL_ERR());
+        if (!parallel)
+            bends++;
+    }
+    return bends;
+}
+
 void DecompositionApproach::solve(bool use_mst)
+{
+    solve(use_mst ? RoutingMode::TERMINAL_MST : RoutingMode::STAR);
+}
+
+void DecompositionApproach::solve(RoutingMode mode)
+{
+    if (mode == RoutingMode::MEHLHORN)
+        solve_mehlhorn();
+    else if (mode == RoutingMode::TREE_GROWING)
+        solve_tree_growing();
+    else if (mode == RoutingMode::EXACT_STEINER)
+        solve_exact_steiner();
+    else
+        solve_decomposition(mode == RoutingMode::TERMINAL_MST);
+}
+
+void DecompositionApproach::solve_decomposition(bool use_mst)
 {
     if(devices.empty())
         return;
@@ -12,10 +53,32 @@ void DecompositionApproach::solve(bool use_mst)
     // Path Generation 
     //Initialize used variable
     vector<CostBend> dist0;
-    vector<vector<CostBend>> dist;
+    vector<CostBend> dist; // 设备间的距离矩阵，按行存放
     MinBendShortestPath mbsp(g_);
+    mbsp.mode = bend_mode;
+    mbsp.key_resolution = key_resolution;
 
-    mbsp.solve(PSB);
+    if (bidirectional && !use_mst && devices.size() == 1)
+        mbsp.solve_bidirectional(PSB, devices[0]);
+    else
+        mbsp.solve(PSB, devices);
+
+    // 保存各起点的最短路树，提取路径时无需重新求解；
+    // 同一起点先求解的树所确定的设备更多，不被替换
+    PathTreeStore trees(tree_memory_limit);
+    if (use_mst)
+        trees.add(mbsp.export_tree());
+    auto path_between = [&](size_t root, size_t v)
+    {
+        vecIndex path;
+        const PathTree *tree = trees.find(root);
+        if (tree == nullptr || !mbsp.get_path(*tree, v, path))
+        {
+            mbsp.solve(root, v);
+            mbsp.get_path(v, path);
+        }
+        return path;
+    };
 
     for(int i = 0; i < devices.size(); i++)
     {
@@ -30,17 +93,8 @@ void DecompositionApproach::solve(bool use_mst)
 
     if (use_mst)
     {
-        for(int i = 0; i < devices.size(); i++)
-        {
-            dist.push_back({});
-            size_t iv = devices[i];
-            mbsp.solve(iv);
-            for(int j=0;j<devices.size(); j++)
-            {
-                size_t jv = devices[j];
-                dist[i].push_back(CostBend(mbsp.distance(jv), mbsp.num_bend(jv), 1e-2));
-            }
-        }
+        // 只求j>i的设备对，求解在最远的所需设备确定后停止
+        dist = terminal_distances(mbsp, devices, 1e-2, num_threads, &trees);
 
         int a0k=0;
         CostBend a0mincb(dist0[0]);
@@ -53,32 +107,17 @@ void DecompositionApproach::solve(bool use_mst)
             }
         }
 
-        mbsp.solve(PSB);
-        paths.push_back(mbsp.get_path(devices[a0k]));
+        paths.push_back(path_between(PSB, devices[a0k]));
         obj = a0mincb;
 
         if(devices.size()>1)
         {
-            Graph h;
-            h.set_vertex_num(devices.size());
-            vector<CostBend> weights;
-            for (int i = 0; i < devices.size(); i++)
+            // 距离矩阵上直接求最小生成树，i < j，可用devices[i]保存的最短路树提取路径
+            for (auto &e : MinimumSpanningTree(dist, devices.size()))
             {
-                for (int j = i + 1; j < devices.size(); j++)
-                {
-                    h.add_edge(i, j);
-                    weights.push_back(dist[i][j]);
-                }
-            }
-            auto mst_h = PrimMinimumSpanningTree(h, weights, 1e-2);
-
-            for (auto ek : mst_h)
-            {
-                auto e = h.edge(ek);
-                int i = e.first, j = e.second;
-                mbsp.solve(devices[i]);
-                paths.push_back(mbsp.get_path(devices[j]));
-                obj += dist[i][j];
+                size_t i = e.first, j = e.second;
+                paths.push_back(path_between(devices[i], devices[j]));
+                obj += dist[i * devices.size() + j];
             }
         }
         
@@ -87,4 +126,141 @@ void DecompositionApproach::solve(bool use_mst)
     {
         obj = accumulate(dist0.begin(), dist0.end(), CostBend(0.0, 0, 1e-2));
     } 
-}
\ No newline at end of file
+}
+
+void DecompositionApproach::solve_mehlhorn()
+{
+    if(devices.empty())
+        return;
+
+    // 终端：起点与各设备，重复的只保留一个
+    vecIndex terminals{PSB};
+    for (size_t dv : devices)
+    {
+        if (find(terminals.begin(), terminals.end(), dv) == terminals.end())
+            terminals.push_back(dv);
+    }
+    map<size_t, size_t> term_index;
+    for (size_t i = 0; i < terminals.size(); i++)
+        term_index[terminals[i]] = i;
+
+    MinBendShortestPath mbsp(g_);
+    mbsp.mode = bend_mode;
+    mbsp.key_resolution = key_resolution;
+    mbsp.solve_multi_source(terminals);
+
+    // 两端属于不同区域的边连接两个终端，每对终端保留代价最小的一条
+    map<pair<size_t, size_t>, pair<CostBend, EdgeIndex>> bridges;
+    for (EdgeIndex k = 0; k < g_.num_edge(); k++)
+    {
+        Edge e = g_.edge(k);
+        size_t su = mbsp.source(e.first), sv = mbsp.source(e.second);
+        if (su == numeric_limits<size_t>::max() || sv == numeric_limits<size_t>::max() || su == sv)
+            continue;
+        // 弯折数由两端的标签和前继得到，只有最小生成树选中的边界边才展开路径
+        CostBend cb(mbsp.distance(e.first) + g_.weight(k) + mbsp.distance(e.second),
+                    mbsp.num_bend_through(e.first, e.second), 1e-2);
+        auto key = minmax(term_index[su], term_index[sv]);
+        auto it = bridges.find(key);
+        if (it == bridges.end() || cb < it->second.first)
+            bridges[key] = make_pair(cb, k);
+    }
+
+    // 终端对的代价填入矩阵，不相邻的对为无穷大；区域相邻关系通常稀疏，由选择器决定用Kruskal或Prim
+    size_t T = terminals.size();
+    vector<CostBend> dist(T * T, CostBend(numeric_limits<double>::infinity(), 0, 1e-2));
+    for (auto &br : bridges)
+    {
+        dist[br.first.first * T + br.first.second] = br.second.first;
+        dist[br.first.second * T + br.first.first] = br.second.first;
+    }
+
+    // 每条树边展开为：一端区域的终端 -> 边界边 -> 另一端区域的终端
+    obj = CostBend(0.0, 0, 1e-2);
+    for (auto &t : MinimumSpanningTree(dist, T))
+    {
+        auto &br = bridges[t];
+        obj += br.first;
+        Edge e = g_.edge(br.second);
+        paths.push_back(mbsp.path_through(e.first, e.second));
+    }
+}
+
+void DecompositionApproach::solve_tree_growing()
+{
+    if(devices.empty())
+        return;
+
+    // 整棵树上的顶点代价均为0，每次连入一条路径后将其顶点加入起点，
+    // 堆和标签保留，只有距新路径更近的顶点被重新扩展
+    MinBendShortestPath mbsp(g_);
+    mbsp.mode = bend_mode;
+    mbsp.key_resolution = key_resolution;
+    obj = CostBend(0.0, 0, 1e-2);
+    for (size_t t = mbsp.solve_nearest({PSB}, devices); t != numeric_limits<size_t>::max();)
+    {
+        vecIndex path;
+        if (mbsp.get_path(t, path))
+        {
+            obj += CostBend(mbsp.distance(t), mbsp.num_bend(t), 1e-2);
+            paths.push_back(path);
+        }
+        // 设备已在树上时无需连接
+        t = mbsp.grow_sources(path);
+    }
+}
+
+void DecompositionApproach::solve_exact_steiner()
+{
+    exact_solved = false;
+    if(devices.empty())
+        return;
+
+    // 以起点为根，按长度求最优树
+    vecIndex terminals(devices.begin(), devices.end());
+    terminals.push_back(PSB);
+    SteinerTree tree = DreyfusWagnerSteinerTree(g_.freeze(), terminals, exact_max_devices + 1, num_threads, exact_memory_limit);
+    if (tree.empty())
+    {
+        solve_tree_growing();
+        return;
+    }
+    exact_solved = true;
+
+    // 从起点出发，在终端和分叉处断开，将树分解为路径
+    map<size_t, vecIndex> adj;
+    for (EdgeIndex k : tree.edges)
+    {
+        Edge e = g_.edge(k);
+        adj[e.first].push_back(e.second);
+        adj[e.second].push_back(e.first);
+    }
+    set<size_t> keys(terminals.begin(), terminals.end());
+    for (auto &a : adj)
+    {
+        if (a.second.size() != 2)
+            keys.insert(a.first);
+    }
+    // 输出的即为求得的最优树本身，代价为树的长度，弯折数按各段路径统计
+    obj = CostBend(tree.cost, 0, 1e-2);
+    vector<pair<size_t, size_t>> stack{make_pair(PSB, numeric_limits<size_t>::max())}; // 路径起点及其来向
+    while (!stack.empty())
+    {
+        size_t s = stack.back().first, from = stack.back().second;
+        stack.pop_back();
+        for (size_t u : adj[s])
+        {
+            if (u == from)
+                continue;
+            vecIndex path{s, u};
+            while (keys.count(path.back()) == 0)
+            {
+                const vecIndex &next = adj[path.back()];
+                path.push_back(next[0] == path[path.size() - 2] ? next[1] : next[0]);
+            }
+            stack.push_back(make_pair(path.back(), path[path.size() - 2]));
+            obj.second += path_bends(g_, path);
+            paths.push_back(path);
+        }
+    }
+}
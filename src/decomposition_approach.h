@@ -2,19 +2,47 @@
 #include "algorithms/mbsp.h"
 namespace ewd
 {
+    /**
+     * @brief 回路的布线方式
+     *
+     */
+    enum class RoutingMode
+    {
+        STAR,         // 起点分别连接各设备
+        TERMINAL_MST, // 起点连接最近的设备，设备之间按最短路距离的最小生成树连接
+        MEHLHORN,     // 一次多起点求解划分各终端的Voronoi区域，在区域边界边构成的终端图上求最小生成树
+        TREE_GROWING, // 从起点逐步生长Steiner树，每次连入距当前树最近的设备（Takahashi–Matsuyama）
+        EXACT_STEINER // 长度最短的Steiner树（Dreyfus–Wagner），设备数超过exact_max_devices或内存超过exact_memory_limit时按TREE_GROWING求解
+    };
+
     class DecompositionApproach
     {
     protected:
-        GeometricGraph& g_;
+        SpatialGraph& g_;
 
     public:
-        DecompositionApproach(GeometricGraph& g): g_(g) {}
+        DecompositionApproach(SpatialGraph& g): g_(g) {}
         ~DecompositionApproach() {} 
 
         size_t PSB;
         std::vector<size_t> devices;
         std::vector<std::vector<size_t>> paths;
         CostBend obj;
+        BendMode bend_mode = BendMode::PREDECESSOR_LISTS; // 最少弯折最短路的求解方式
+        size_t tree_memory_limit = size_t(64) << 20;       // 保存最短路树的内存上限，超出后重新求解
+        size_t num_threads = 0;                            // 设备间距离的求解线程数，0：使用硬件线程数
+        size_t exact_max_devices = 8;                      // EXACT_STEINER精确求解的设备数上限
+        size_t exact_memory_limit = size_t(64) << 20;      // EXACT_STEINER动态规划表的内存上限，2万个顶点时约可求解8个设备
+        bool exact_solved = false;                         // 最近一次EXACT_STEINER是否按精确算法求得，否则已按TREE_GROWING求解
+        bool bidirectional = false;                        // STAR方式只有一个设备时按双向搜索求解
+        double key_resolution = 0.0;                       // 大于0时最少弯折最短路的堆键按此精度量化压缩
         void solve(bool use_mst = true);
+        void solve(RoutingMode mode);
+
+    protected:
+        void solve_decomposition(bool use_mst);
+        void solve_mehlhorn();
+        void solve_tree_growing();
+        void solve_exact_steiner();
     };
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <numeric>
 #include <ctime>
 #include <cmath>
+#include <limits>
 #include "base/algorithm_error.h"
 template <typename T1, typename T2>
 constexpr auto MIN(T1 X, T2 Y) { return (Y) < (X) ? (Y) : (X); }
@@ -81,9 +82,14 @@ namespace ewd
 		walls_.push_back(wl);
 		walls_.back().set_offset(0.0);
 		wall_id_map_[wl.get_id()] = walls_.size() - 1;
+		barrier_index_ready_ = false;
 	}
 
-	void GraphConstructor::add_door(const Door &wd) { doors_.push_back(wd); }
+	void GraphConstructor::add_door(const Door &wd)
+	{
+		doors_.push_back(wd);
+		barrier_index_ready_ = false;
+	}
 	size_t GraphConstructor::num_vertex() const { return g.num_vertex(); }
 	size_t GraphConstructor::num_edge() const { return g.num_edge(); }
 	Point GraphConstructor::vertex(size_t i) const { return g.vertex(i); }
@@ -91,27 +97,30 @@ namespace ewd
 
 	EdgeIndex GraphConstructor::add_edge(VertexIndex i, VertexIndex j, bool further_check)
 	{
-		Point v1(g.vertex(i)), v2(g.vertex(j));
-		if(valid_point(v1) && valid_point(v2))
+		if(edge_allowed(g.vertex(i), g.vertex(j)))
 		{
-			if(! LnThroughNotPass(v1,v2))
-			{
-
-				EdgeIndex k;
-				if(further_check)
-					k = g.add_edge(i, j);	
-				else
-					k=g.add_edge_simply(i, j);
-				return k;
-			}
+			EdgeIndex k;
+			if(further_check)
+				k = g.add_edge(i, j);	
+			else
+				k=g.add_edge_simply(i, j);
+			return k;
 		}
 		return g.num_edge();
 	}
 
+	bool GraphConstructor::edge_allowed(const Point &v1, const Point &v2) const
+	{
+		return valid_point(v1) && valid_point(v2) && !LnThroughNotPass(v1, v2);
+	}
+
 	bool GraphConstructor::LnThroughNotPass(const Point &pnt0, const Point &pnt1, double offset, bool checkwindoor) const
 	{
-		for (const Wall &wl : walls_)
+		vecIndex cand_walls, cand_doors, hosted;
+		candidate_walls(pnt0, pnt1, offset + 2 * ABS_ERR, cand_walls);
+		for (size_t i : cand_walls)
 		{
+			const Wall &wl = walls_[i];
 			if ((!wl.allow_through()) || (fabs(wl.get_u() * (pnt1 - pnt0).normalized()) > 0.7))
 			{
 				auto rslt = wl.HousingIntersectLineSegment(pnt0, pnt1, floor_height);
@@ -119,10 +128,10 @@ namespace ewd
 				{
 					auto rslt = wl.HousingIntersectLineSegment(pnt0, pnt1, floor_height);
 					double len = rslt.second.second - rslt.second.first;
-					for (const Door &wd : doors_)
+					hosted_doors(i, hosted);
+					for (size_t d : hosted)
 					{
-						if (wd.get_host() != wl.get_id())
-							continue;
+						const Door &wd = doors_[d];
 						auto t_wd = wd.HousingIntersectLineSegment(pnt0, pnt1, floor_height);
 						if (t_wd.first != LineCuboidRelation::DISJOINT)
 							len -= t_wd.second.second - t_wd.second.first;
@@ -133,7 +142,7 @@ namespace ewd
 			}
 		}
 		vector<size_t> related_wall_ind;
-		for (size_t i = 0; i < walls_.size(); i++)
+		for (size_t i : cand_walls)
 		{
 			const Wall &wl = walls_[i];
 			if ((!wl.allow_through()))
@@ -142,10 +151,10 @@ namespace ewd
 				if (rslt.first==LineCuboidRelation::INTERSECTING && rslt.second.first <= rslt.second.second - ABS_ERR)
 				{
 					double len = rslt.second.second - rslt.second.first;
-					for (const Door &wd : doors_)
+					hosted_doors(i, hosted);
+					for (size_t d : hosted)
 					{
-						if (wd.get_host() != wl.get_id())
-							continue;
+						const Door &wd = doors_[d];
 						auto t_wd = wd.HousingIntersectLineSegment(pnt0, pnt1, floor_height, offset);
 						if (t_wd.first != LineCuboidRelation::DISJOINT)
 							len -= t_wd.second.second - t_wd.second.first;
@@ -187,8 +196,10 @@ namespace ewd
 			return true;
 		if (!checkwindoor)
 			return false;
-		for (const HouseInwallBarrier &br : doors_)
+		candidate_doors(pnt0, pnt1, offset, cand_doors);
+		for (size_t d : cand_doors)
 		{
+			const HouseInwallBarrier &br = doors_[d];
 			auto rslt= br.IntvIntersectLineSegment(pnt0, pnt1, floor_height, offset);
 			if (rslt.first==LineCuboidRelation::INTERSECTING)
 			{
@@ -206,7 +217,10 @@ namespace ewd
         out[LineCuboidRelation::COINCIDENT] = 0.0;
         out[LineCuboidRelation::INTERSECTING] = 0.0;
 		double addition_along_solid=0.0; // 绕梁产生
-		for(size_t i=0;i<walls_.size();i++)
+		vecIndex cand_walls, cand_doors;
+		candidate_walls(pnt1, pnt2, 0.0, cand_walls);
+		candidate_doors(pnt1, pnt2, 0.0, cand_doors);
+		for(size_t i : cand_walls)
 		{
 			auto& wl = walls_[i];
 			auto rslt = wl.HousingIntersectLineSegment(pnt1,pnt2,floor_height);
@@ -224,7 +238,7 @@ namespace ewd
 					along_solid.push_back(rslt.second);
 			}
 		}
-		for(size_t i=0;i<doors_.size();i++)
+		for(size_t i : cand_doors)
 		{
 			auto& wd = doors_[i];
 			auto rslt = wd.HousingIntersectLineSegment(pnt1,pnt2,floor_height);
@@ -291,6 +305,7 @@ namespace ewd
 
 	int GraphConstructor::DoorProcess()
 	{
+		barrier_index_ready_ = false;
 		for (size_t k = 0; k < doors_.size(); k++)
 		{
 			for (const Wall &wl : walls_)
@@ -382,6 +397,7 @@ namespace ewd
 
 	void GraphConstructor::WallsPreprocess()
 	{
+		barrier_index_ready_ = false;
 		vector<double>  walls_forward_extension_, walls_backward_extension_;
 		for (const auto &wl : walls_)
 		{
@@ -442,6 +458,7 @@ namespace ewd
 		through_wall_conduit_unit_cost = conf.through_wall_conduit_unit_cost;
 		in_groove_conduit_unit_cost = conf.in_groove_conduit_unit_cost;
 		conduit_unit_cost = conf.conduit_unit_cost;
+		line_sweep = conf.line_sweep;
 	}
 	void GraphConstructor::set_mini_radius(double r) 					{ mini_radius = r; }
 	void GraphConstructor::set_conduit_unit_cost(double c)				{ conduit_unit_cost = c;}
@@ -451,6 +468,7 @@ namespace ewd
 	void GraphConstructor::set_neutral_wire_unit_cost(double c) 		{ neutral_wire_unit_cost = c; }
 	void GraphConstructor::set_earth_wire_unit_cost(double c) 			{ earth_wire_unit_cost = c; }
 	void GraphConstructor::set_connect_threshold(double t) 				{ connect_threshold = t; }
+	void GraphConstructor::set_line_sweep(bool b) 						{ line_sweep = b; }
 
 	void GraphConstructor::set_PSB(const Device& dev)
 	{
@@ -464,58 +482,128 @@ namespace ewd
 
 	void GraphConstructor::calc_costs()
 	{
+		through_wall_lengths_.resize(num_edge());
+		in_groove_lengths_.resize(num_edge());
+		free_lengths_.resize(num_edge());
 		for (size_t k = 0; k < num_edge(); k++)
 		{
 			Edge e = edge(k);
-			bool _ = false;
-			Point& v1 = vertex(e.first);
-			Point& v2 = vertex(e.second);
-			
-			// double dom = live_wire_unit_cost + neutral_wire_unit_cost+earth_wire_unit_cost+through_wall_conduit_unit_cost+in_groove_conduit_unit_cost+conduit_unit_cost;
-			double dom = 1.0;
-			bool onceil = (v1.z > floor_height - ABS_ERR) && (v2.z > floor_height - ABS_ERR);
-			bool onfloor= (v1.z < ABS_ERR) && (v2.z < ABS_ERR);
-			auto analysis = intersection_analysis(v1,v2);
-			double totallen = 0.0;
-			for(auto& p: analysis) totallen+=p.second;
-
-			double clive = totallen * live_wire_unit_cost/dom;
-			double cneutral = totallen * neutral_wire_unit_cost/dom;
-			double cearth = totallen * earth_wire_unit_cost/dom;
-			double cConduit = 0.0;
-			cConduit += through_wall_conduit_unit_cost/dom * analysis[LineCuboidRelation::INTERSECTING];
-			cConduit += in_groove_conduit_unit_cost/dom * analysis[LineCuboidRelation::COINCIDENT];
-			cConduit += conduit_unit_cost/dom * analysis[LineCuboidRelation::DISJOINT];
-
-			g.set_edge_weight(k, clive+cneutral+cearth+cConduit);
+			EdgeLengths lens = edge_lengths(vertex(e.first), vertex(e.second));
+			through_wall_lengths_[k] = lens.intersecting;
+			in_groove_lengths_[k] = lens.coincident;
+			free_lengths_[k] = lens.disjoint;
 		}
+		reweight();
 	}
 
-	void GraphConstructor::finalDeletingCheck()
+	void GraphConstructor::reweight(const Config& conf)
+	{
+		live_wire_unit_cost = conf.live_wire_unit_cost;
+		neutral_wire_unit_cost = conf.neutral_wire_unit_cost;
+		earth_wire_unit_cost = conf.earth_wire_unit_cost;
+		through_wall_conduit_unit_cost = conf.through_wall_conduit_unit_cost;
+		in_groove_conduit_unit_cost = conf.in_groove_conduit_unit_cost;
+		conduit_unit_cost = conf.conduit_unit_cost;
+		reweight();
+	}
+
+	// 一条边的线缆与线管费用，单价为参数以便reweight()中的循环向量化
+	static inline double wire_cost(const EdgeLengths &lens, double clive, double cneutral, double cearth,
+								   double cwall, double cgroove, double cfree)
+	{
+		double totallen = lens.disjoint + lens.intersecting + lens.coincident;
+		double cConduit = cwall * lens.intersecting + cgroove * lens.coincident + cfree * lens.disjoint;
+		return totallen * clive + totallen * cneutral + totallen * cearth + cConduit;
+	}
+
+	void GraphConstructor::reweight()
+	{
+		size_t m = through_wall_lengths_.size();
+		vecDouble weights(m);
+		const double *lw = through_wall_lengths_.data(), *lg = in_groove_lengths_.data(), *lf = free_lengths_.data();
+		double *w = weights.data();
+		const double clive = live_wire_unit_cost, cneutral = neutral_wire_unit_cost, cearth = earth_wire_unit_cost;
+		const double cwall = through_wall_conduit_unit_cost, cgroove = in_groove_conduit_unit_cost, cfree = conduit_unit_cost;
+		// 各边互不相关，循环可被编译器向量化
+		for (size_t k = 0; k < m; k++)
+			w[k] = wire_cost(EdgeLengths{lw[k], lg[k], lf[k]}, clive, cneutral, cearth, cwall, cgroove, cfree);
+		g.set_edge_weights(weights);
+	}
+
+	EdgeLengths GraphConstructor::edge_lengths(const Point& pnt1, const Point& pnt2)
 	{
-		for (size_t k = 0; k < g.num_edge();)
+		EdgeLengths out;
+		GridLine *line = find_grid_line(pnt1, pnt2);
+		if (line != nullptr)
 		{
-			if (LnThroughNotPass(vertex(edge(k).first), vertex(edge(k).second),0.0,false)){
-				g.remove_edge(k);
+			if (!line->analysed)
+				analyse_grid_line(*line);
+			double a = pnt1[line->axis], b = pnt2[line->axis];
+			if (!line->needs_exact(a, b, ABS_ERR, REL_ERR))
+			{
+				out.intersecting = line->intersecting_length(a, b);
+				out.coincident = line->coincident_length(a, b);
+				out.disjoint = pnt1.distance(pnt2) + line->beam_addition(a, b, pnt1.z, pnt2.z) - out.intersecting - out.coincident;
+				return out;
 			}
-			else
-				k++;
 		}
+		auto analysis = intersection_analysis(pnt1, pnt2);
+		out.intersecting = analysis[LineCuboidRelation::INTERSECTING];
+		out.coincident = analysis[LineCuboidRelation::COINCIDENT];
+		out.disjoint = analysis[LineCuboidRelation::DISJOINT];
+		return out;
+	}
+
+	void GraphConstructor::finalDeletingCheck()
+	{
+		// 先标记，最后一次压缩边数组、邻接表与各边的长度
+		for (size_t k = 0; k < g.num_edge(); k++)
+		{
+			if (LnThroughNotPass(vertex(edge(k).first), vertex(edge(k).second),0.0,false))
+				g.mark_removed(k);
+		}
+		vecIndex new_index = g.compact_removed();
+		size_t m = 0;
+		for (size_t k = 0; k < free_lengths_.size() && k < new_index.size(); k++)
+		{
+			if (new_index[k] == numeric_limits<size_t>::max())
+				continue;
+			through_wall_lengths_[m] = through_wall_lengths_[k];
+			in_groove_lengths_[m] = in_groove_lengths_[k];
+			free_lengths_[m] = free_lengths_[k];
+			m++;
+		}
+		through_wall_lengths_.resize(m);
+		in_groove_lengths_.resize(m);
+		free_lengths_.resize(m);
 	}
 
 	void GraphConstructor::construct()
+	{
+		preprocess();
+		build_graph();
+	}
+
+	int GraphConstructor::preprocess()
 	{
 		int err;
 		WallsPreprocess();
 		err = DoorProcess();
+		build_barrier_index();
 
-		vector<double> xs,ys;
+		base_xs_.clear();
+		base_ys_.clear();
+		collect_wall_grid(base_xs_, base_ys_);
+		collect_door_grid(base_xs_, base_ys_);
+		return err;
+	}
 
-		collect_wall_grid(xs, ys);
-		collect_door_grid(xs, ys);
+	void GraphConstructor::build_graph()
+	{
+		vector<double> xs(base_xs_), ys(base_ys_);
 		collect_device_grid(xs, ys);
 
-		Hanan(xs,ys,{3300.0});
+		Hanan(xs, ys, base_zs_);
 
 		calc_costs();
 	}
@@ -578,84 +666,448 @@ namespace ewd
 		}
 	}
 
-	void GraphConstructor::Hanan(const vector<double>& xs, const vector<double>& ys, const vector<double>& zs)
+	GridLine GraphConstructor::make_grid_line(int axis, const Point& origin) const
+	{
+		GridLine line(axis, origin);
+		// 点查询只看水平位置，故竖直方向不设限
+		BoundingBox probe = BoundingBox::vertical_column(origin);
+		if (axis == 0)
+		{
+			probe.lower.x = -numeric_limits<double>::infinity();
+			probe.upper.x = numeric_limits<double>::infinity();
+		}
+		else if (axis == 1)
+		{
+			probe.lower.y = -numeric_limits<double>::infinity();
+			probe.upper.y = numeric_limits<double>::infinity();
+		}
+		for (const BoundingVolumeHierarchy *bvh : {&walls_bvh_, &doors_bvh_})
+		{
+			vecIndex &cands = (bvh == &walls_bvh_) ? line.walls : line.doors;
+			bvh->query(probe, cands);
+			for (size_t i : cands)
+			{
+				const BoundingBox &b = bvh->box(i);
+				if (axis == 2)
+					line.hazards.push_back(make_pair(-numeric_limits<double>::infinity(), numeric_limits<double>::infinity()));
+				else
+					line.hazards.push_back(make_pair(b.lower[axis], b.upper[axis]));
+			}
+		}
+		intervals_union(line.hazards);
+		return line;
+	}
+
+	GridLine& GraphConstructor::grid_line(int axis, const Point& origin, double lower, double upper)
+	{
+		auto key = (axis == 0) ? make_tuple(0, origin.y, origin.z)
+				 : (axis == 1) ? make_tuple(1, origin.x, origin.z)
+							   : make_tuple(2, origin.x, origin.y);
+		auto it = grid_lines_.find(key);
+		if (it == grid_lines_.end())
+		{
+			it = grid_lines_.insert(make_pair(key, make_grid_line(axis, origin))).first;
+			it->second.lower = lower;
+			it->second.upper = upper;
+			return it->second;
+		}
+		GridLine &line = it->second;
+		if (lower < line.lower || upper > line.upper)
+		{
+			// 范围扩大后，已有的分析结果不再适用
+			line.lower = MIN(line.lower, lower);
+			line.upper = MAX(line.upper, upper);
+			line.analysed = false;
+		}
+		return line;
+	}
+
+	void GraphConstructor::prepare_grid_lines()
+	{
+		if (!barrier_index_ready_ || base_xs_.empty() || base_ys_.empty())
+			return;
+		const vector<double> &xs = base_xs_, &ys = base_ys_, &zs = base_zs_;
+		for (double z : zs)
+		{
+			for (double y : ys)
+				analyse_grid_line(grid_line(0, Point(0.0, y, z), xs.front(), xs.back()));
+			for (double x : xs)
+				analyse_grid_line(grid_line(1, Point(x, 0.0, z), ys.front(), ys.back()));
+		}
+	}
+
+	GridLine* GraphConstructor::find_grid_line(const Point& pnt1, const Point& pnt2)
+	{
+		int axis;
+		if (pnt1.y == pnt2.y && pnt1.z == pnt2.z)
+			axis = 0;
+		else if (pnt1.x == pnt2.x && pnt1.z == pnt2.z)
+			axis = 1;
+		else if (pnt1.x == pnt2.x && pnt1.y == pnt2.y)
+			axis = 2;
+		else
+			return nullptr;
+		auto key = (axis == 0) ? make_tuple(0, pnt1.y, pnt1.z)
+				 : (axis == 1) ? make_tuple(1, pnt1.x, pnt1.z)
+							   : make_tuple(2, pnt1.x, pnt1.y);
+		auto it = grid_lines_.find(key);
+		if (it == grid_lines_.end())
+			return nullptr;
+		return &it->second;
+	}
+
+	void GraphConstructor::analyse_grid_line(GridLine& line) const
+	{
+		line.analysed = true;
+		line.exact_only = false;
+		const double ALIGN_ERR = 1e-6;	// 障碍物与网格线的偏斜在全线上造成的横向偏差上限
+		Point dir = line.point_at(1.0) - line.point_at(0.0);
+
+		vector<interval<double>> along_windoor, intersecting_solid, along_solid, uncertain;
+		vector<pair<interval<double>, double>> beams;
+		vector<GridLine::Breakpoint> bps;
+
+		// 求障碍物在线上的碰撞关系，无法由整线推出各边结果时返回false
+		auto analyse = [&](const HouseBarrier& br, const BoundingBox& box, pair<LineCuboidRelation, interval<double>>& rslt) -> bool
+		{
+			const Cuboid &cu = br.cu();
+			double lo = box.lower[line.axis], hi = box.upper[line.axis];
+			double span = MAX(line.upper, hi) - MIN(line.lower, lo);
+
+			// 障碍物须与网格线对齐：恰有一个轴沿线方向，其余轴上的偏斜可忽略
+			Point axes[3] = {cu.get_l_direc(), cu.get_w_direc(), cu.get_h_direc()};
+			double dims[3] = {cu.get_length(), cu.get_width(), cu.get_height()};
+			int along = -1;
+			for (int j = 0; j < 3; j++)
+			{
+				if (fabs(axes[j] * dir) * span <= ALIGN_ERR)
+					continue;
+				if (along >= 0)
+					return false;
+				along = j;
+			}
+			if (along < 0)
+				return false;
+
+			auto r = br.HousingIntersectLineSegment(line.point_at(lo), line.point_at(hi), floor_height);
+			if (r.first == LineCuboidRelation::DISJOINT)
+			{
+				// 横向落在障碍物内却不相交：沿线的重叠过短，由各边自行判断
+				Point p = line.point_at((lo + hi) / 2) - cu.get_base();
+				bool inside = true;
+				for (int j = 0; j < 3; j++)
+				{
+					if (j == along)
+						continue;
+					double c = p * axes[j] / dims[j];
+					inside &= (c >= -ABS_ERR / dims[j]) && (c <= 1 + ABS_ERR / dims[j]);
+				}
+				if (inside)
+					uncertain.push_back(make_pair(lo, hi));
+				rslt.first = LineCuboidRelation::DISJOINT;
+				return true;
+			}
+			double scale = (cu.get_l() + cu.get_w() + cu.get_h()).norm();
+			if (scale <= 2 * ABS_ERR)
+				return false;
+			interval<double> range = make_pair(lo + r.second.first, lo + r.second.second);
+			bps.push_back(GridLine::Breakpoint{range.first, range, scale});
+			bps.push_back(GridLine::Breakpoint{range.second, range, scale});
+			rslt = make_pair(r.first, range);
+			return true;
+		};
+
+		pair<LineCuboidRelation, interval<double>> rslt;
+		for (size_t i : line.walls)
+		{
+			auto& wl = walls_[i];
+			if (!analyse(wl, walls_bvh_.box(i), rslt))
+			{
+				line.exact_only = true;
+				return;
+			}
+			if (rslt.first == LineCuboidRelation::DISJOINT) continue;
+			if (wl.get_name().find("beam") != string::npos)
+			{
+				beams.push_back(make_pair(rslt.second, wl.get_start().z));
+				along_solid.push_back(rslt.second);
+			}
+			else
+			{
+				if (rslt.first == LineCuboidRelation::INTERSECTING)
+					intersecting_solid.push_back(rslt.second);
+				else
+					along_solid.push_back(rslt.second);
+			}
+		}
+		for (size_t i : line.doors)
+		{
+			if (!analyse(doors_[i], doors_bvh_.box(i), rslt))
+			{
+				line.exact_only = true;
+				return;
+			}
+			if (rslt.first == LineCuboidRelation::DISJOINT) continue;
+			along_windoor.push_back(rslt.second);
+		}
+
+		// 与intersection_analysis相同的合并顺序
+		intervals_union(along_windoor);
+		intervals_union(along_solid);
+		intervals_union(intersecting_solid);
+		intervals_exclude(along_windoor, intersecting_solid);
+		intervals_exclude(intersecting_solid, along_solid);
+		intervals_union(along_solid);
+		intervals_union(intersecting_solid);
+		vector<interval<double>> alongs;
+		for (auto in : along_windoor)
+			alongs.push_back(in);
+		for (auto in : along_solid)
+			alongs.push_back(in);
+		intervals_union(alongs);
+
+		line.set_coverage(intersecting_solid, alongs, beams, bps, uncertain);
+	}
+
+	template <typename AddEdge>
+	void GraphConstructor::sweep_hanan(const vector<double>& xs, const vector<double>& ys, const vector<double>& zs, AddEdge &&add)
 	{
 		int nx = xs.size(), ny = ys.size(), nz = zs.size();
-		
+
+		// 每条网格线与障碍物求交一次，供扫描加边与代价计算共用
+		// 扫描模式：线上远离障碍物的边直接加入
+		bool sweep = line_sweep && barrier_index_ready_;
+		vector<GridLine*> xlines, ylines, zlines;
+		if (barrier_index_ready_)
+		{
+			for(int k=0;k<nz;k++)
+			{
+				for(int j=0;j<ny;j++)
+					xlines.push_back(&grid_line(0, Point(0.0, ys[j], zs[k]), xs.front(), xs.back()));
+				for(int i=0;i<nx;i++)
+					ylines.push_back(&grid_line(1, Point(xs[i], 0.0, zs[k]), ys.front(), ys.back()));
+			}
+			if (nz > 1)
+			{
+				for(int j=0;j<ny;j++)
+					for(int i=0;i<nx;i++)
+						zlines.push_back(&grid_line(2, Point(xs[i], ys[j], 0.0), zs.front(), zs.back()));
+			}
+		}
+		auto try_edge = [&](size_t v1, size_t v2, int axis, const Point& p1, const Point& p2, GridLine* line, double a, double b)
+		{
+			if ((sweep && line->clear(a, b)) || edge_allowed(p1, p2))
+				add(v1, v2, axis);
+		};
+
 		for(int k=0;k<nz;k++)
 		{
 			for(int j=0;j<ny;j++)
 			{
 				for(int i=0;i<nx;i++)
-				{ 
-					
-					size_t pnt = g.add_vertex_simply(Point(xs[i], ys[j], zs[k]));
-					
+				{
+					size_t pnt = i+nx*j+nx*ny*k;
+					Point p(xs[i], ys[j], zs[k]);
 					if(i>0)
-					{
-						add_edge(pnt, (i-1)+nx*j+nx*ny*k);	
-					}
+						try_edge(pnt, (i-1)+nx*j+nx*ny*k, 0, p, Point(xs[i-1], ys[j], zs[k]), sweep ? xlines[j+ny*k] : nullptr, xs[i-1], xs[i]);
 					if(j>0)
-					{
-						add_edge(pnt, i+nx*(j-1)+nx*ny*k);
-					}
+						try_edge(pnt, i+nx*(j-1)+nx*ny*k, 1, p, Point(xs[i], ys[j-1], zs[k]), sweep ? ylines[i+nx*k] : nullptr, ys[j-1], ys[j]);
 					if(k>0)
-					{
-						add_edge(pnt, i+nx*j+nx*ny*(k-1));
-					}
+						try_edge(pnt, i+nx*j+nx*ny*(k-1), 2, p, Point(xs[i], ys[j], zs[k-1]), sweep ? zlines[i+nx*j] : nullptr, zs[k-1], zs[k]);
 				}
 			}
 		}
+	}
+
+	template <typename GraphT, typename AddEdge>
+	void GraphConstructor::attach_devices(GraphT& gr, AddEdge &&add)
+	{
         //Check z location of psb
 		if(fabs(PSB.location.z)<3300.0-ABS_ERR)
 		{
-			PSB_index = g.add_vertex_simply(PSB.location);
-			add_edge(PSB_index, g.find_vertex(Point(PSB.location.x, PSB.location.y, 3300.0)));
+			PSB_index = gr.add_vertex_simply(PSB.location);
+			add(PSB_index, gr.find_vertex(Point(PSB.location.x, PSB.location.y, 3300.0)), false);
 		}
 		else
-			PSB_index = g.find_vertex(PSB.location);
+			PSB_index = gr.find_vertex(PSB.location);
 		
 
 	     //Check z location of devices. Either adds node or connects to projection
+		devices_indices.clear();
 		for(auto& dev : devices)
 		{
 			if(fabs(dev.location.z)<3300.0-ABS_ERR)
 			{
-				devices_indices.push_back(g.add_vertex_simply(dev.location));
-				add_edge(devices_indices.back(), g.find_vertex(Point(dev.location.x, dev.location.y, 3300.0)));
+				devices_indices.push_back(gr.add_vertex_simply(dev.location));
+				add(devices_indices.back(), gr.find_vertex(Point(dev.location.x, dev.location.y, 3300.0)), false);
 			}
 			else 
-				devices_indices.push_back(g.find_vertex(dev.location));
+				devices_indices.push_back(gr.find_vertex(dev.location));
 			if (dev.name == "Junction Box")
 			{
 				JB_index = devices_indices.back();
 			}
 		}
 
-		for(int i=0;i<devices.size();i++)
+		for(size_t i=0;i<devices.size();i++)
 		{
-			for(int j=i+1;j<devices.size();j++)
+			for(size_t j=i+1;j<devices.size();j++)
 			{
 				if(devices[i].location.distance(devices[j].location) <= connect_threshold)
-					add_edge(devices_indices[i], devices_indices[j],true);
+					add(devices_indices[i], devices_indices[j],true);
 			}
 		}
 	}
 
+	void GraphConstructor::Hanan(const vector<double>& xs, const vector<double>& ys, const vector<double>& zs)
+	{
+		grid_xs_ = xs;
+		grid_ys_ = ys;
+		grid_zs_ = zs;
+		for(double z : zs)
+			for(double y : ys)
+				for(double x : xs)
+					g.add_vertex_simply(Point(x, y, z));
+		sweep_hanan(xs, ys, zs, [&](size_t v1, size_t v2, int) { g.add_edge_simply(v1, v2); });
+		attach_devices(g, [&](size_t i, size_t j, bool further_check) { add_edge(i, j, further_check); });
+	}
+
+	GridGraph GraphConstructor::build_grid_graph()
+	{
+		vector<double> xs(base_xs_), ys(base_ys_);
+		collect_device_grid(xs, ys);
+		grid_xs_ = xs;
+		grid_ys_ = ys;
+		grid_zs_ = base_zs_;
+
+		GridGraph gg(xs, ys, base_zs_);
+		gg.set_REL_ERR(g.REL_ERR());
+		gg.set_ABS_ERR(g.ABS_ERR());
+		gg.set_WEAK_PARALLEL_ERR(g.WEAK_PARALLEL_ERR());
+		// 网格边在Hanan()中总由编号大的一端连向相邻顶点，此处记为低端顶点的可通行位
+		sweep_hanan(xs, ys, base_zs_, [&](size_t, size_t lo, int axis) { gg.set_passable(axis, lo); });
+		gg.build_edges();
+		attach_devices(gg, [&](size_t i, size_t j, bool further_check)
+		{
+			if (i == j || i >= gg.num_vertex() || j >= gg.num_vertex())
+				return;
+			if (further_check && gg.find_edge(i, j) < gg.num_edge())
+				return;
+			if (edge_allowed(gg.vertex(i), gg.vertex(j)))
+				gg.add_edge(i, j);
+		});
+
+		vecDouble weights(gg.num_edge());
+		for (EdgeIndex k = 0; k < gg.num_edge(); k++)
+		{
+			Edge e = gg.edge(k);
+			weights[k] = wire_cost(edge_lengths(gg.vertex(e.first), gg.vertex(e.second)),
+								   live_wire_unit_cost, neutral_wire_unit_cost, earth_wire_unit_cost,
+								   through_wall_conduit_unit_cost, in_groove_conduit_unit_cost, conduit_unit_cost);
+		}
+		gg.set_edge_weights(weights);
+		return gg;
+	}
+
 	bool GraphConstructor::valid_point(const Point& p) const
 	{
 		bool out = true;
-		for(auto& wl: walls_)
+		vecIndex cands;
+		if (barrier_index_ready_)
+			walls_bvh_.query_point(p, cands);
+		else
+			candidate_walls(p, p, 0.0, cands);
+		for(size_t i : cands)
 		{
-			out &= (! wl.IsContainPoint(p,floor_height));
+			out &= (! walls_[i].IsContainPoint(p,floor_height));
 		}
 		if(!out)
 		{
-			for(auto& d: doors_)
+			if (barrier_index_ready_)
+				doors_bvh_.query_point(p, cands);
+			else
+				candidate_doors(p, p, 0.0, cands);
+			for(size_t i : cands)
 			{
-				out |= d.IsContainPoint(p,floor_height);
+				out |= doors_[i].IsContainPoint(p,floor_height);
 			}
 		}
 		return out;
 	}
+
+	void GraphConstructor::build_barrier_index()
+	{
+		// 包围盒外扩：覆盖碰撞判断中的绝对误差与相对误差
+		vector<BoundingBox> boxes;
+		for (const Wall &wl : walls_)
+		{
+			BoundingBox b;
+			for (const Point &p : wl.GetCorners())
+				b.expand(p);
+			b.inflate(2 * (ABS_ERR + REL_ERR * (b.upper - b.lower).norm()));
+			boxes.push_back(b);
+		}
+		walls_bvh_.build(boxes);
+
+		boxes.clear();
+		for (const Door &wd : doors_)
+		{
+			BoundingBox b;
+			for (const Point &p : wd.GetCorners(offset_door))
+				b.expand(p);
+			b.inflate(2 * (ABS_ERR + REL_ERR * (b.upper - b.lower).norm()));
+			boxes.push_back(b);
+		}
+		doors_bvh_.build(boxes);
+		grid_lines_.clear();
+
+		map<string, vecIndex> host_doors;
+		for (size_t d = 0; d < doors_.size(); d++)
+			host_doors[doors_[d].get_host()].push_back(d);
+		wall_doors_.assign(walls_.size(), vecIndex());
+		for (size_t i = 0; i < walls_.size(); i++)
+		{
+			auto it = host_doors.find(walls_[i].get_id());
+			if (it != host_doors.end())
+				wall_doors_[i] = it->second;
+		}
+		barrier_index_ready_ = true;
+	}
+
+	void GraphConstructor::candidate_walls(const Point &pnt0, const Point &pnt1, double margin, vecIndex &out) const
+	{
+		if (barrier_index_ready_)
+		{
+			walls_bvh_.query_segment(pnt0, pnt1, margin, out);
+			return;
+		}
+		out.resize(walls_.size());
+		iota(out.begin(), out.end(), 0);
+	}
+
+	void GraphConstructor::candidate_doors(const Point &pnt0, const Point &pnt1, double margin, vecIndex &out) const
+	{
+		if (barrier_index_ready_)
+		{
+			doors_bvh_.query_segment(pnt0, pnt1, margin, out);
+			return;
+		}
+		out.resize(doors_.size());
+		iota(out.begin(), out.end(), 0);
+	}
+
+	void GraphConstructor::hosted_doors(size_t i, vecIndex &out) const
+	{
+		if (barrier_index_ready_)
+		{
+			out = wall_doors_[i];
+			return;
+		}
+		out.clear();
+		for (size_t d = 0; d < doors_.size(); d++)
+		{
+			if (doors_[d].get_host() == walls_[i].get_id())
+				out.push_back(d);
+		}
+	}
 }
\ No newline at end of file
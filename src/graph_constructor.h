@@ -2,9 +2,13 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <tuple>
 #include "base/point.h"
 #include "base/graph.h"
+#include "base/grid_graph.h"
+#include "base/bvh.h"
 #include "barrier.h"
+#include "grid_line.h"
 
 
 namespace ewd
@@ -50,6 +54,21 @@ namespace ewd
 		double through_wall_conduit_unit_cost = 1.0;
 		double conduit_unit_cost = 1.0;
 		double in_groove_conduit_unit_cost = 1.0;
+
+        bool line_sweep = true;
+    };
+
+    /**
+     * @brief 一条边穿墙、沿墙（槽内）、不接触墙体的长度
+     * 绕梁产生的额外长度计入disjoint
+     */
+    struct EdgeLengths
+    {
+        double intersecting = 0.0;
+        double coincident = 0.0;
+        double disjoint = 0.0;
+
+        double total() const { return disjoint + intersecting + coincident; }
     };
 
     class GraphConstructor
@@ -70,11 +89,26 @@ namespace ewd
 		double conduit_unit_cost = 1.0;
 		double in_groove_conduit_unit_cost = 1.0;
 
+        bool line_sweep = true;     // 按网格线扫描障碍物，跳过远离障碍物的边的碰撞检查
+
         std::vector<Wall> walls_;
         std::map<std::string, size_t> wall_id_map_;
         std::vector<Door> doors_;
 
+        BoundingVolumeHierarchy walls_bvh_;
+        BoundingVolumeHierarchy doors_bvh_;
+        std::vector<vecIndex> wall_doors_;  // 每面墙上的门窗编号
+        bool barrier_index_ready_ = false;
+        std::map<std::tuple<int, double, double>, GridLine> grid_lines_;   // Hanan网格线，键为方向与另两个坐标
+        vecDouble base_xs_, base_ys_;       // 墙体与门窗确定的网格坐标，不含设备
+        vecDouble base_zs_ = {3300.0};
+        vecDouble grid_xs_, grid_ys_, grid_zs_; // 最近一次Hanan()的网格坐标，g的前nx*ny*nz个顶点即网格顶点
+
         GeometricGraph g;
+        // 每条边穿墙、沿墙、不接触墙体的长度，与g的边一一对应，换算边权时无需重新求交
+        vecDouble through_wall_lengths_;
+        vecDouble in_groove_lengths_;
+        vecDouble free_lengths_;
         Device PSB;
         size_t PSB_index;
         size_t JB_index;
@@ -86,6 +120,25 @@ namespace ewd
 
         void construct();
 
+        /**
+         * @brief 建图的第一步：墙体与门窗预处理，建立障碍物索引和基础网格坐标
+         * 与设备无关，可在多个回路间共享
+         * @return int 错误码
+         */
+        int preprocess();
+
+        /**
+         * @brief 建图的第二步：加入设备网格坐标，建立Hanan网格并计算边权
+         * 需要先调用preprocess
+         */
+        void build_graph();
+
+        /**
+         * @brief 预先分析基础网格的所有网格线
+         * 复制本对象后，各回路直接复用分析结果
+         */
+        void prepare_grid_lines();
+
         void add_wall(const Wall &wl);
         void add_door(const Door &wd);
         void set_PSB(const Device& dev);
@@ -93,6 +146,14 @@ namespace ewd
 
         void read_config(const Config& conf);
 
+        /**
+         * @brief 按conf中的线缆、线管单价重新计算边权
+         * 只使用已记录的各边长度，不重新建图和求交
+         * @param conf 配置，只读取单价
+         */
+        void reweight(const Config& conf);
+        void reweight();
+
         void set_floor_height(double height);
         void set_offset_door(double off);
         void set_mini_radius(double r);
@@ -103,16 +164,30 @@ namespace ewd
 		void set_neutral_wire_unit_cost(double c);
 		void set_earth_wire_unit_cost(double c);
 		void set_connect_threshold(double t);
+		void set_line_sweep(bool b);
 
         size_t num_vertex() const;
         size_t num_edge() const;
         Point vertex(size_t i) const;
         Edge edge(size_t k) const;
 
+        /**
+         * @brief 代替build_graph()，由Hanan网格的扫描直接建立隐式网格图，不生成g
+         * 扫描与碰撞判断同build_graph()，顶点编号、PSB_index、devices_indices与之相同；
+         * 边权按当前单价直接计算，不记录各边长度，reweight()对其无效。需要先调用preprocess
+         * @return GridGraph
+         */
+        GridGraph build_grid_graph();
+
     // private:
 
         EdgeIndex add_edge(VertexIndex v1, VertexIndex v2, bool further_check=false);
 
+        /**
+         * @brief 两点间能否连边：两端均不在墙体内，且线段不穿过不可穿越的障碍物
+         */
+        bool edge_allowed(const Point &v1, const Point &v2) const;
+
         /**
          * @brief 给定某线段和该线段所在的墙体，获取该线段与所有其他墙体的碰撞范围
          * 
@@ -142,6 +217,24 @@ namespace ewd
 
         std::map<LineCuboidRelation,double> intersection_analysis(const Point& pnt1, const Point& pnt2) const ;
 
+        /**
+         * @brief 在墙体和门窗上建立包围盒层次树，供碰撞查询使用
+         * 墙体或门窗变动后需要重新建立
+         */
+        void build_barrier_index();
+
+        /**
+         * @brief 获取包围盒与线段pnt0-pnt1相交的墙体编号（升序）
+         * 
+         * @param pnt0 线段起点
+         * @param pnt1 线段终点
+         * @param margin 线段包围盒外扩量
+         * @param out 墙体编号
+         */
+        void candidate_walls(const Point &pnt0, const Point &pnt1, double margin, vecIndex &out) const;
+        void candidate_doors(const Point &pnt0, const Point &pnt1, double margin, vecIndex &out) const;
+        void hosted_doors(size_t i, vecIndex &out) const;
+
         int DoorProcess();
         bool CheckConnect(std::set<size_t> &pointnums) const;
         void WallsPreprocess();
@@ -153,6 +246,65 @@ namespace ewd
         void collect_door_grid(std::vector<double>& xs, std::vector<double>& ys);
         void collect_device_grid(std::vector<double>& xs, std::vector<double>& ys);
         void Hanan(const std::vector<double>& xs, const std::vector<double>& ys, const std::vector<double>& zs);
+
+        /**
+         * @brief 扫描Hanan网格的所有网格边，对可连的边调用add(v1, v2, axis)
+         * v2为网格顶点v1在axis负向的相邻顶点，顶点编号为i + nx*(j + ny*k)
+         */
+        template <typename AddEdge>
+        void sweep_hanan(const std::vector<double>& xs, const std::vector<double>& ys, const std::vector<double>& zs, AddEdge &&add);
+
+        /**
+         * @brief 加入低于吊顶的配电箱与设备顶点，确定PSB_index、devices_indices，
+         * 并对需要的顶点对调用add(i, j, further_check)
+         */
+        template <typename GraphT, typename AddEdge>
+        void attach_devices(GraphT& gr, AddEdge &&add);
+
+        /**
+         * @brief 建立过origin、沿axis方向的网格线，求出障碍物在其上的区间
+         * 需要先建立障碍物包围盒层次树
+         * @param axis 方向：0-x，1-y，2-z
+         * @param origin 线上一点
+         * @return GridLine 
+         */
+        GridLine make_grid_line(int axis, const Point& origin) const;
+
+        /**
+         * @brief 获取过origin、沿axis方向的网格线，不存在则建立
+         * 
+         * @param axis 方向：0-x，1-y，2-z
+         * @param origin 线上一点
+         * @param lower 线上网格点坐标的下界
+         * @param upper 线上网格点坐标的上界
+         * @return GridLine& 
+         */
+        GridLine& grid_line(int axis, const Point& origin, double lower, double upper);
+
+        /**
+         * @brief 查找线段pnt1-pnt2所在的网格线
+         * 
+         * @param pnt1 线段起点
+         * @param pnt2 线段终点
+         * @return GridLine* 线段不在已有网格线上时为nullptr
+         */
+        GridLine* find_grid_line(const Point& pnt1, const Point& pnt2);
+
+        /**
+         * @brief 对整条网格线做一次与intersection_analysis相同的分析，记录各类区间的前缀长度
+         * 
+         * @param line 网格线
+         */
+        void analyse_grid_line(GridLine& line) const;
+
+        /**
+         * @brief 线段pnt1-pnt2的各类长度
+         * 位于网格线上且远离障碍物端点的线段直接查表，否则调用intersection_analysis
+         * @param pnt1 线段起点
+         * @param pnt2 线段终点
+         * @return EdgeLengths 
+         */
+        EdgeLengths edge_lengths(const Point& pnt1, const Point& pnt2);
     };
 
 } 
\ No newline at end of file
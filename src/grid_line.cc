@@ -0,0 +1,152 @@
+#include "grid_line.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace ewd
+{
+    Point GridLine::point_at(double t) const
+    {
+        Point p = origin;
+        if (axis == 0)
+            p.x = t;
+        else if (axis == 1)
+            p.y = t;
+        else
+            p.z = t;
+        return p;
+    }
+
+    bool GridLine::overlaps(const vector<interval<double>> &intvs, double a, double b)
+    {
+        // 区间互不相交且升序，右端点同样升序
+        auto it = lower_bound(intvs.begin(), intvs.end(), a,
+                              [](const interval<double> &intv, double t) { return intv.second < t; });
+        return it != intvs.end() && it->first <= b;
+    }
+
+    bool GridLine::clear(double a, double b) const
+    {
+        if (a > b)
+            std::swap(a, b);
+        return !overlaps(hazards, a, b);
+    }
+
+    void GridLine::set_coverage(const vector<interval<double>> &intersecting_intvs,
+                                const vector<interval<double>> &coincident_intvs,
+                                const vector<pair<interval<double>, double>> &beams,
+                                const vector<Breakpoint> &bps,
+                                const vector<interval<double>> &uncertain_intvs)
+    {
+        intersecting = intersecting_intvs;
+        coincident = coincident_intvs;
+        uncertain = uncertain_intvs;
+        intervals_union(uncertain);
+
+        auto prefix = [](const vector<interval<double>> &intvs, vecDouble &out)
+        {
+            out.assign(1, 0.0);
+            for (auto &intv : intvs)
+                out.push_back(out.back() + max(0.0, intv.second - intv.first));
+        };
+        prefix(intersecting, intersecting_prefix);
+        prefix(coincident, coincident_prefix);
+
+        beam_starts.clear();
+        beam_ends.clear();
+        for (auto &bm : beams)
+        {
+            beam_starts.push_back(make_pair(bm.first.first, bm.second));
+            beam_ends.push_back(make_pair(bm.first.second, bm.second));
+        }
+        sort(beam_starts.begin(), beam_starts.end());
+        sort(beam_ends.begin(), beam_ends.end());
+        beam_start_prefix.assign(1, 0.0);
+        for (auto &p : beam_starts)
+            beam_start_prefix.push_back(beam_start_prefix.back() + p.second);
+        beam_end_prefix.assign(1, 0.0);
+        for (auto &p : beam_ends)
+            beam_end_prefix.push_back(beam_end_prefix.back() + p.second);
+
+        breakpoints = bps;
+        sort(breakpoints.begin(), breakpoints.end(),
+             [](const Breakpoint &b1, const Breakpoint &b2) { return b1.t < b2.t; });
+        analysed = true;
+    }
+
+    bool GridLine::needs_exact(double a, double b, double ABS_ERR, double REL_ERR) const
+    {
+        const double EPS = 1e-6; // 整线与单边分别求交的舍入误差上限
+        if (exact_only)
+            return true;
+        if (a > b)
+            std::swap(a, b);
+        double len = b - a;
+        if (len <= ABS_ERR + EPS || a < lower || b > upper)
+            return true;
+        if (overlaps(uncertain, a, b))
+            return true;
+
+        // 端点远离[a,b]的障碍物或完全包含该边，或与之不相交，结果与整线一致
+        double window = 2 * ABS_ERR;
+        auto it = lower_bound(breakpoints.begin(), breakpoints.end(), a - window,
+                              [](const Breakpoint &bp, double t) { return bp.t < t; });
+        for (; it != breakpoints.end() && it->t <= b + window; it++)
+        {
+            double s = it->range.first, e = it->range.second;
+            if (len <= 2 * REL_ERR * it->scale)
+            {
+                // 边相对障碍物过短时，沿线方向按起点是否在障碍物内判断
+                bool inside = a >= s - EPS && b <= e + EPS;
+                bool outside = b < s - ABS_ERR - EPS || a > e + ABS_ERR + EPS;
+                if (!inside && !outside)
+                    return true;
+            }
+            else
+            {
+                // 重叠长度须明确高于或低于碰撞判断的阈值
+                double overlap = max(0.0, min(e, b) - max(s, a));
+                if (overlap > EPS && overlap <= max(ABS_ERR * len / it->scale, ABS_ERR) + EPS)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    double GridLine::covered_length(const vector<interval<double>> &intvs, const vecDouble &prefix, double x)
+    {
+        auto it = upper_bound(intvs.begin(), intvs.end(), x,
+                              [](double t, const interval<double> &intv) { return t < intv.first; });
+        size_t k = it - intvs.begin();
+        double len = prefix[k];
+        if (k > 0 && intvs[k - 1].second > x)
+            len -= intvs[k - 1].second - x;
+        return len;
+    }
+
+    double GridLine::intersecting_length(double a, double b) const
+    {
+        return fabs(covered_length(intersecting, intersecting_prefix, b) - covered_length(intersecting, intersecting_prefix, a));
+    }
+
+    double GridLine::coincident_length(double a, double b) const
+    {
+        return fabs(covered_length(coincident, coincident_prefix, b) - covered_length(coincident, coincident_prefix, a));
+    }
+
+    double GridLine::beam_addition(double a, double b, double z1, double z2) const
+    {
+        if (a > b)
+            std::swap(a, b);
+        // 与[a,b]相交的梁：起点小于b，且终点不小于等于a
+        size_t ns = lower_bound(beam_starts.begin(), beam_starts.end(), b,
+                                [](const pair<double, double> &p, double t) { return p.first < t; }) -
+                    beam_starts.begin();
+        size_t ne = upper_bound(beam_ends.begin(), beam_ends.end(), a,
+                                [](double t, const pair<double, double> &p) { return t < p.first; }) -
+                    beam_ends.begin();
+        double count = double(ns) - double(ne);
+        return count * (z1 + z2) - 2 * (beam_start_prefix[ns] - beam_end_prefix[ne]);
+    }
+}
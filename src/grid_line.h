@@ -0,0 +1,105 @@
+#pragma once
+#include "base/point.h"
+#include "base/types.h"
+#include "algorithms/interval.h"
+#include <vector>
+
+namespace ewd
+{
+    /**
+     * @brief Hanan网格线
+     * 沿坐标轴方向的直线，记录所有障碍物包围盒在其上的投影区间。
+     * 不与任何区间相交的线段必然不与障碍物碰撞，无需逐一检查。
+     * 完成代价分析后，还记录穿墙、沿墙（槽内）区间的前缀长度，
+     * 线上任一条边的三类长度只需两次查找和一次相减。
+     */
+    class GridLine
+    {
+    public:
+        /**
+         * @brief 单个障碍物在线上的碰撞区间端点
+         * 端点附近的边的碰撞判断带有随边长变化的误差阈值，需逐一核对
+         */
+        struct Breakpoint
+        {
+            double t;                // 端点坐标
+            interval<double> range;  // 所属障碍物的碰撞区间
+            double scale;            // 所属障碍物的尺度
+        };
+
+        int axis = 0;      // 方向：0-x，1-y，2-z
+        Point origin;      // 线上一点，axis方向的分量无意义
+        double lower = 0.0, upper = 0.0;       // 线上网格点的坐标范围
+        std::vector<interval<double>> hazards; // 障碍物区间，已合并且升序
+        vecIndex walls, doors;                 // 包围盒与网格线相交的墙体、门窗
+
+        bool analysed = false;   // 是否已完成代价分析
+        bool exact_only = false; // 存在与网格线斜交的障碍物，只能逐边分析
+        std::vector<interval<double>> intersecting, coincident; // 穿墙、沿墙区间，已合并且升序
+        vecDouble intersecting_prefix, coincident_prefix;
+        std::vector<std::pair<double, double>> beam_starts, beam_ends; // 梁区间的端点与梁底高度，升序
+        vecDouble beam_start_prefix, beam_end_prefix;
+        std::vector<Breakpoint> breakpoints; // 升序
+        std::vector<interval<double>> uncertain; // 整线分析无法确定结果的区间，已合并且升序
+
+        GridLine() {}
+        GridLine(int ax, const Point &p) : axis(ax), origin(p) {}
+
+        Point point_at(double t) const;
+
+        /**
+         * @brief 判断线上区间[a,b]是否与所有障碍物区间都不相交
+         *
+         * @param a 区间左端点
+         * @param b 区间右端点
+         * @return true
+         * @return false
+         */
+        bool clear(double a, double b) const;
+
+        /**
+         * @brief 写入代价分析结果，计算前缀长度
+         *
+         * @param intersecting_intvs 穿墙区间
+         * @param coincident_intvs 沿墙区间
+         * @param beams 梁区间及梁底高度
+         * @param bps 障碍物区间端点
+         * @param uncertain_intvs 无法确定结果的区间
+         */
+        void set_coverage(const std::vector<interval<double>> &intersecting_intvs,
+                          const std::vector<interval<double>> &coincident_intvs,
+                          const std::vector<std::pair<interval<double>, double>> &beams,
+                          const std::vector<Breakpoint> &bps,
+                          const std::vector<interval<double>> &uncertain_intvs);
+
+        /**
+         * @brief 判断线上的边[a,b]能否直接查表，否则需要逐边分析
+         *
+         * @param a 边的一端
+         * @param b 边的另一端
+         * @param ABS_ERR 绝对误差
+         * @param REL_ERR 相对误差
+         * @return true 需要逐边分析
+         * @return false
+         */
+        bool needs_exact(double a, double b, double ABS_ERR, double REL_ERR) const;
+
+        double intersecting_length(double a, double b) const;
+        double coincident_length(double a, double b) const;
+
+        /**
+         * @brief 与[a,b]相交的梁带来的绕梁长度
+         *
+         * @param a 边的一端
+         * @param b 边的另一端
+         * @param z1 一端的高度
+         * @param z2 另一端的高度
+         * @return double
+         */
+        double beam_addition(double a, double b, double z1, double z2) const;
+
+    private:
+        static bool overlaps(const std::vector<interval<double>> &intvs, double a, double b);
+        static double covered_length(const std::vector<interval<double>> &intvs, const vecDouble &prefix, double x);
+    };
+}
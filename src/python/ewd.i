@@ -12,11 +12,13 @@
     #include "base/cuboid.h"
     #include "base/types.h"
     #include "base/graph.h"
+    #include "base/grid_graph.h"
     #include "algorithms/argheap.h"
     #include "algorithms/mbsp.h"
     #include "barrier.h"
     #include "graph_constructor.h"
     #include "decomposition_approach.h"
+    #include "circuit_batch.h"
 %}
 
 %include "base/point.h"
@@ -24,10 +26,12 @@
 %include "base/cuboid.h"
 %include "base/types.h"
 %include "base/graph.h"
+%include "base/grid_graph.h"
 %include "algorithms/mbsp.h"
 %include "barrier.h"
 %include "graph_constructor.h"
 %include "decomposition_approach.h"
+%include "circuit_batch.h"
 
 
 namespace std {
@@ -36,4 +40,6 @@ namespace std {
     %template(vecDoub) vector<double>;
     %template(matDoub) vector<vector<double>>;
     %template(Edge) pair<size_t, size_t>;
+    %template(vecDevice) vector<ewd::Device>;
+    %template(vecCircuitResult) vector<ewd::CircuitResult>;
 }
\ No newline at end of file
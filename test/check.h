@@ -0,0 +1,28 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+
+// 各测试程序共用的检查宏：失败时打印位置并计数，main()返回失败数
+
+namespace ewd_test
+{
+    inline int &failures()
+    {
+        static int n = 0;
+        return n;
+    }
+}
+
+#define EWD_CHECK(cond)                                                         \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ewd_test::failures()++;                                             \
+        }                                                                       \
+    } while (0)
+
+#define EWD_CHECK_NEAR(a, b, tol) EWD_CHECK(std::fabs(double(a) - double(b)) <= (tol))
+
+#define EWD_TEST_RESULT() (ewd_test::failures() == 0 ? 0 : 1)
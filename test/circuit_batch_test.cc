@@ -0,0 +1,79 @@
+#include "check.h"
+#include "scene.h"
+#include "circuit_batch.h"
+#include "decomposition_approach.h"
+
+using namespace std;
+using namespace ewd;
+
+// 批量求解的各回路与单独建图、求解的结果相同
+
+namespace
+{
+    struct Single
+    {
+        GraphConstructor gc;
+        CostBend obj, home_run_obj;
+        vector<vecIndex> paths;
+    };
+
+    // 与CircuitBatch::solve_circuit()相同的求解步骤，但完整地建一次图
+    void solve_single(Single &s, const vector<Device> &devices, const Config &conf)
+    {
+        GraphConstructor &gc = s.gc;
+        ewd_test::add_floor(gc);
+        ewd_test::add_circuit(gc, devices);
+        gc.read_config(conf);
+        gc.construct();
+
+        DecompositionApproach da(gc.g);
+        da.num_threads = 1;
+        da.PSB = gc.JB_index;
+        da.devices = gc.devices_indices;
+        da.solve(false);
+        s.obj = da.obj;
+        da.PSB = gc.PSB_index;
+        da.devices = {gc.JB_index};
+        da.solve(false);
+        s.home_run_obj = da.obj;
+        s.paths = da.paths;
+    }
+}
+
+int main()
+{
+    Config floor;
+    Config cheap_wall = floor;
+    cheap_wall.through_wall_conduit_unit_cost = 0.5;
+    cheap_wall.live_wire_unit_cost = 2.0;
+    vector<vector<Device>> circuits = {ewd_test::circuit_a(), ewd_test::circuit_b(), ewd_test::circuit_a()};
+    vector<Config> configs = {floor, floor, cheap_wall};
+
+    CircuitBatch batch;
+    batch.num_threads = 2;
+    ewd_test::add_floor(batch);
+    batch.read_config(floor);
+    for (size_t i = 0; i < circuits.size(); i++)
+        batch.add_circuit("c" + to_string(i), circuits[i], configs[i]);
+    batch.solve();
+    EWD_CHECK(batch.results.size() == circuits.size());
+
+    for (size_t i = 0; i < circuits.size() && i < batch.results.size(); i++)
+    {
+        Single s;
+        solve_single(s, circuits[i], configs[i]);
+        const CircuitResult &r = batch.results[i];
+        EWD_CHECK(r.id == "c" + to_string(i));
+        EWD_CHECK(r.gc.num_vertex() == s.gc.num_vertex());
+        EWD_CHECK(r.gc.num_edge() == s.gc.num_edge());
+        for (EdgeIndex k = 0; k < r.gc.num_edge() && k < s.gc.num_edge(); k++)
+        {
+            EWD_CHECK(r.gc.edge(k) == s.gc.edge(k));
+            EWD_CHECK_NEAR(r.gc.g.weight(k), s.gc.g.weight(k), 1e-9);
+        }
+        EWD_CHECK(r.obj == s.obj);
+        EWD_CHECK(r.home_run_obj == s.home_run_obj);
+        EWD_CHECK(r.paths == s.paths);
+    }
+    return EWD_TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+#include "check.h"
+#include "decomposition_approach.h"
+#include "algorithms/steiner_tree.h"
+#include <climits>
+#include <numeric>
+#include <random>
+
+using namespace std;
+using namespace ewd;
+
+// 分解求解的各种布线方式与逐个设备求最短路的结果比较
+
+namespace
+{
+    // nx×ny网格，边权为边长乘1到3
+    GeometricGraph grid(size_t nx, size_t ny, unsigned seed)
+    {
+        mt19937 rng(seed);
+        uniform_int_distribution<int> factor(1, 3);
+        GeometricGraph g;
+        for (size_t j = 0; j < ny; j++)
+            for (size_t i = 0; i < nx; i++)
+                g.add_vertex_simply(Point(i * 100.0, j * 100.0, 0.0));
+        for (size_t j = 0; j < ny; j++)
+            for (size_t i = 0; i < nx; i++)
+            {
+                size_t v = i + nx * j;
+                if (i + 1 < nx)
+                    g.add_edge(v, v + 1, 100.0 * factor(rng));
+                if (j + 1 < ny)
+                    g.add_edge(v, v + nx, 100.0 * factor(rng));
+            }
+        return g;
+    }
+
+    double path_weight(const GeometricGraph &g, const vecIndex &path)
+    {
+        double w = 0.0;
+        for (size_t i = 0; i + 1 < path.size(); i++)
+        {
+            EdgeIndex k = g.find_edge(path[i], path[i + 1]);
+            EWD_CHECK(k < g.num_edge());
+            if (k < g.num_edge())
+                w += g.weight(k);
+        }
+        return w;
+    }
+
+    // 网格上的路径：相邻两段不同轴即为一次弯折
+    int path_bends(const GeometricGraph &g, const vecIndex &path)
+    {
+        int bends = 0;
+        for (size_t i = 1; i + 1 < path.size(); i++)
+        {
+            EdgeDirection a = direction_code(g.vertex(path[i]) - g.vertex(path[i - 1]));
+            EdgeDirection b = direction_code(g.vertex(path[i + 1]) - g.vertex(path[i]));
+            bends += !same_axis(a, b);
+        }
+        return bends;
+    }
+
+    size_t find_root(vecIndex &parent, size_t v)
+    {
+        while (parent[v] != v)
+            v = parent[v] = parent[parent[v]];
+        return v;
+    }
+
+    // 各路径的并连通起点与所有设备
+    bool connects(const GeometricGraph &g, const vector<vecIndex> &paths, size_t root, const vecIndex &devices)
+    {
+        vecIndex parent(g.num_vertex());
+        iota(parent.begin(), parent.end(), size_t(0));
+        for (const vecIndex &p : paths)
+        {
+            for (size_t i = 0; i + 1 < p.size(); i++)
+                parent[find_root(parent, p[i])] = find_root(parent, p[i + 1]);
+        }
+        for (size_t d : devices)
+        {
+            if (find_root(parent, d) != find_root(parent, root))
+                return false;
+        }
+        return true;
+    }
+
+    // 按长度的Steiner最小树的代价，作为近似方式的下界
+    double steiner_cost(const GeometricGraph &g, size_t root, const vecIndex &devices)
+    {
+        vecIndex terminals(devices);
+        terminals.push_back(root);
+        return DreyfusWagnerSteinerTree(g.freeze(), terminals).cost;
+    }
+
+    // MEHLHORN与TREE_GROWING：路径连通所有终端，代价与弯折数由路径本身复算，
+    // 总代价在Steiner最小树的1到2倍之间
+    void test_approximation(const GeometricGraph &g0, size_t root, const vecIndex &devices, BendMode mode, RoutingMode routing)
+    {
+        GeometricGraph g = g0;
+        DecompositionApproach da(g);
+        da.PSB = root;
+        da.devices = devices;
+        da.bend_mode = mode;
+        da.solve(routing);
+        EWD_CHECK(da.paths.size() == devices.size());
+        EWD_CHECK(connects(g, da.paths, root, devices));
+        double w = 0.0;
+        int bends = 0;
+        for (const vecIndex &p : da.paths)
+        {
+            w += path_weight(g, p);
+            bends += path_bends(g, p);
+        }
+        EWD_CHECK_NEAR(da.obj.first, w, 1e-6);
+        EWD_CHECK(da.obj.second == bends);
+        double opt = steiner_cost(g, root, devices);
+        EWD_CHECK(da.obj.first >= opt - 1e-6);
+        EWD_CHECK(da.obj.first <= 2.0 * opt + 1e-6);
+    }
+
+    // EXACT_STEINER：输出的即为Dreyfus–Wagner求得的树，超出设备数或内存上限时按TREE_GROWING求解
+    void test_exact(const GeometricGraph &g0, size_t root, const vecIndex &devices, BendMode mode)
+    {
+        GeometricGraph g = g0;
+        DecompositionApproach da(g);
+        da.PSB = root;
+        da.devices = devices;
+        da.bend_mode = mode;
+        da.solve(RoutingMode::EXACT_STEINER);
+        EWD_CHECK(da.exact_solved);
+        EWD_CHECK(connects(g, da.paths, root, devices));
+        double w = 0.0;
+        int bends = 0;
+        for (const vecIndex &p : da.paths)
+        {
+            w += path_weight(g, p);
+            bends += path_bends(g, p);
+        }
+        EWD_CHECK_NEAR(da.obj.first, steiner_cost(g, root, devices), 1e-6);
+        EWD_CHECK_NEAR(w, da.obj.first, 1e-6);
+        EWD_CHECK(da.obj.second == bends);
+
+        DecompositionApproach fallback(g), growing(g);
+        fallback.PSB = growing.PSB = root;
+        fallback.devices = growing.devices = devices;
+        fallback.bend_mode = growing.bend_mode = mode;
+        fallback.exact_max_devices = devices.size() - 1;
+        fallback.solve(RoutingMode::EXACT_STEINER);
+        growing.solve(RoutingMode::TREE_GROWING);
+        EWD_CHECK(!fallback.exact_solved);
+        EWD_CHECK(fallback.obj == growing.obj);
+        EWD_CHECK(fallback.paths == growing.paths);
+
+        DecompositionApproach capped(g);
+        capped.PSB = root;
+        capped.devices = devices;
+        capped.bend_mode = mode;
+        capped.exact_memory_limit = DreyfusWagnerMemory(g.num_vertex(), devices.size() + 1) - 1;
+        capped.solve(RoutingMode::EXACT_STEINER);
+        EWD_CHECK(!capped.exact_solved);
+        EWD_CHECK(capped.obj == growing.obj);
+    }
+
+    // 有设备不可达时，STAR方式的目标为(无穷大, int最大值)
+    void test_unreachable_star()
+    {
+        GeometricGraph g = grid(4, 4, 2);
+        size_t island = g.add_vertex_simply(Point(1000.0, 1000.0, 0.0));
+        DecompositionApproach da(g);
+        da.PSB = 0;
+        da.devices = {5, island, 15};
+        da.solve(RoutingMode::STAR);
+        EWD_CHECK(da.obj.first == numeric_limits<double>::infinity());
+        EWD_CHECK(da.obj.second == INT_MAX);
+        EWD_CHECK(da.paths.size() == 3 && da.paths[1].empty());
+    }
+}
+
+int main()
+{
+    test_unreachable_star();
+    const BendMode modes[] = {BendMode::PREDECESSOR_LISTS, BendMode::DIRECTION_STATES};
+    unsigned seed = 1;
+    for (const vecIndex &devices : {vecIndex{7, 30, 44}, vecIndex{3, 12, 25, 40, 47}, vecIndex{9, 10, 11, 20, 33, 46, 2}})
+    {
+        GeometricGraph g = grid(8, 6, seed++);
+        for (BendMode mode : modes)
+        {
+            test_approximation(g, 0, devices, mode, RoutingMode::MEHLHORN);
+            test_approximation(g, 0, devices, mode, RoutingMode::TREE_GROWING);
+            test_exact(g, 0, devices, mode);
+        }
+    }
+    return EWD_TEST_RESULT();
+}
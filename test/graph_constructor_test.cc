@@ -0,0 +1,61 @@
+#include "check.h"
+#include "scene.h"
+
+using namespace std;
+using namespace ewd;
+
+// 建图的快速路径与逐边检查的结果一致
+
+namespace
+{
+    void build(GraphConstructor &gc, const vector<Device> &devices, bool line_sweep)
+    {
+        ewd_test::add_floor(gc);
+        ewd_test::add_circuit(gc, devices);
+        gc.set_line_sweep(line_sweep);
+        gc.construct();
+    }
+
+    // 按网格线扫描与逐边碰撞检查得到相同的图
+    void test_line_sweep(const vector<Device> &devices)
+    {
+        GraphConstructor a, b;
+        build(a, devices, true);
+        build(b, devices, false);
+        EWD_CHECK(a.num_vertex() == b.num_vertex());
+        EWD_CHECK(a.num_edge() == b.num_edge());
+        for (VertexIndex v = 0; v < a.num_vertex() && v < b.num_vertex(); v++)
+            EWD_CHECK(a.vertex(v) == b.vertex(v));
+        for (EdgeIndex k = 0; k < a.num_edge() && k < b.num_edge(); k++)
+        {
+            EWD_CHECK(a.edge(k) == b.edge(k));
+            EWD_CHECK_NEAR(a.g.weight(k), b.g.weight(k), 1e-9);
+        }
+        EWD_CHECK(a.PSB_index == b.PSB_index);
+        EWD_CHECK(a.devices_indices == b.devices_indices);
+    }
+
+    // 网格线前缀和给出的各类长度与逐边求交相同
+    void test_edge_lengths(const vector<Device> &devices)
+    {
+        GraphConstructor gc;
+        build(gc, devices, true);
+        for (EdgeIndex k = 0; k < gc.num_edge(); k++)
+        {
+            Point p1 = gc.vertex(gc.edge(k).first), p2 = gc.vertex(gc.edge(k).second);
+            auto exact = gc.intersection_analysis(p1, p2);
+            EWD_CHECK_NEAR(gc.through_wall_lengths_[k], exact[LineCuboidRelation::INTERSECTING], 1e-6);
+            EWD_CHECK_NEAR(gc.in_groove_lengths_[k], exact[LineCuboidRelation::COINCIDENT], 1e-6);
+            EWD_CHECK_NEAR(gc.free_lengths_[k], exact[LineCuboidRelation::DISJOINT], 1e-6);
+        }
+    }
+}
+
+int main()
+{
+    test_line_sweep(ewd_test::circuit_a());
+    test_line_sweep(ewd_test::circuit_b());
+    test_edge_lengths(ewd_test::circuit_a());
+    test_edge_lengths(ewd_test::circuit_b());
+    return EWD_TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+#include "check.h"
+#include "base/graph.h"
+#include "algorithms/mbsp.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+
+using namespace std;
+using namespace ewd;
+
+// 图的各种视图与原始邻接表一致
+
+namespace
+{
+    typedef tuple<VertexIndex, EdgeIndex, double> Item;
+
+    // 含平行边的随机图
+    Graph random_graph(size_t n, size_t m, mt19937 &rng)
+    {
+        uniform_int_distribution<size_t> pick(0, n - 1);
+        uniform_real_distribution<double> w(1.0, 10.0);
+        Graph g;
+        g.set_vertex_num(n);
+        while (g.num_edge() < m)
+        {
+            size_t a = pick(rng), b = pick(rng);
+            if (a != b)
+                g.add_edge(a, b, w(rng));
+        }
+        return g;
+    }
+
+    // 邻接表中未标记删除的项，按邻居、边编号升序
+    vector<Item> adjacency(const Graph &g, VertexIndex v)
+    {
+        vector<Item> items;
+        for (EdgeIndex k : g.GetAdjacentEdges(v))
+        {
+            if (!g.is_removed(k))
+                items.emplace_back(g.opposite(v, k), k, g.weight(k));
+        }
+        sort(items.begin(), items.end());
+        return items;
+    }
+
+    // 冻结的CSR视图与邻接表一致
+    void check_freeze(const Graph &g)
+    {
+        CsrGraph csr = g.freeze();
+        EWD_CHECK(csr.num_vertex() == g.num_vertex());
+        EWD_CHECK(csr.num_edge() == g.num_edge());
+        for (VertexIndex v = 0; v < g.num_vertex(); v++)
+        {
+            vector<Item> items;
+            for (size_t i = csr.begin(v); i < csr.end(v); i++)
+                items.emplace_back(csr.neighbor(i), csr.edge_id(i), csr.weight(i));
+            EWD_CHECK(items == adjacency(g, v));
+        }
+    }
+
+    // 遍历邻居时平行边只取权重最小的一条，与reachable_neighbors()的映射相同
+    void check_neighbors(const Graph &g)
+    {
+        CsrGraph csr = g.freeze();
+        for (VertexIndex v = 0; v < g.num_vertex(); v++)
+        {
+            map<size_t, double> expected;
+            for (const Item &it : adjacency(g, v))
+            {
+                auto found = expected.find(get<0>(it));
+                if (found == expected.end() || get<2>(it) < found->second)
+                    expected[get<0>(it)] = get<2>(it);
+            }
+            map<size_t, double> by_graph, by_csr;
+            g.for_each_neighbor(v, [&](VertexIndex u, EdgeIndex k, double w) {
+                EWD_CHECK(g.weight(k) == w);
+                by_graph[u] = w;
+            });
+            csr.for_each_neighbor(v, [&](size_t i, double w) { by_csr[csr.neighbor(i)] = w; });
+            EWD_CHECK(by_graph == expected);
+            EWD_CHECK(by_csr == expected);
+            EWD_CHECK(g.reachable_neighbors(v) == expected);
+        }
+    }
+
+    // 边集合：(端点, 权重)，与编号无关
+    vector<tuple<VertexIndex, VertexIndex, double>> edge_set(const Graph &g)
+    {
+        vector<tuple<VertexIndex, VertexIndex, double>> es;
+        for (EdgeIndex k = 0; k < g.num_edge(); k++)
+            es.emplace_back(g.edge(k).first, g.edge(k).second, g.weight(k));
+        return es;
+    }
+
+    void test_freeze()
+    {
+        mt19937 rng(7);
+        Graph g = random_graph(30, 120, rng);
+        check_freeze(g);
+        check_neighbors(g);
+    }
+
+    void test_tombstones()
+    {
+        mt19937 rng(11);
+        Graph g = random_graph(25, 80, rng);
+        vecIndex ks;
+        for (EdgeIndex k = 0; k < g.num_edge(); k += 3)
+            ks.push_back(k);
+
+        // 标记后、压缩前：冻结与遍历跳过已标记的边
+        Graph marked = g;
+        for (EdgeIndex k : ks)
+            marked.mark_removed(k);
+        check_freeze(marked);
+
+        Graph batch = g;
+        vecIndex new_index = batch.remove_edges(ks);
+        Graph single = g;
+        for (size_t i = ks.size(); i-- > 0;)
+            single.remove_edge(ks[i]);
+        EWD_CHECK(edge_set(batch) == edge_set(single));
+        check_freeze(batch);
+        for (VertexIndex v = 0; v < g.num_vertex(); v++)
+            EWD_CHECK(batch.GetAdjacentEdges(v) == single.GetAdjacentEdges(v));
+        for (EdgeIndex k = 0; k < g.num_edge(); k++)
+        {
+            bool removed = binary_search(ks.begin(), ks.end(), k);
+            EWD_CHECK(removed == (new_index[k] == numeric_limits<size_t>::max()));
+            if (!removed)
+                EWD_CHECK(batch.edge(new_index[k]) == g.edge(k));
+        }
+
+        // remove_edge()在压缩前调用时，其余标记随编号前移
+        Graph mixed = g;
+        mixed.mark_removed(5);
+        mixed.mark_removed(9);
+        Edge e9 = mixed.edge(9);
+        mixed.remove_edge(2);
+        EWD_CHECK(mixed.is_removed(4) && mixed.is_removed(8));
+        EWD_CHECK(!mixed.is_removed(5) && !mixed.is_removed(9));
+        EWD_CHECK(mixed.edge(8) == e9);
+        check_freeze(mixed);
+    }
+
+    // 标记删除后版本号递增，同一个求解器重新冻结并绕开被标记的边；重复标记不再递增
+    void test_mark_removed_resolve()
+    {
+        GeometricGraph g;
+        g.add_vertex_simply(Point(0.0, 0.0, 0.0));
+        g.add_vertex_simply(Point(100.0, 0.0, 0.0));
+        g.add_vertex_simply(Point(0.0, 100.0, 0.0));
+        g.add_vertex_simply(Point(100.0, 100.0, 0.0));
+        g.add_edge(0, 1, 100.0);
+        g.add_edge(0, 2, 100.0);
+        g.add_edge(2, 3, 100.0);
+        g.add_edge(3, 1, 100.0);
+
+        MinBendShortestPath mbsp(g);
+        mbsp.solve(0);
+        EWD_CHECK_NEAR(mbsp.distance(1), 100.0, 1e-9);
+
+        size_t version = g.version();
+        g.mark_removed(0);
+        EWD_CHECK(g.version() != version);
+        version = g.version();
+        g.mark_removed(0);
+        EWD_CHECK(g.version() == version);
+
+        mbsp.solve(0);
+        EWD_CHECK_NEAR(mbsp.distance(1), 300.0, 1e-9);
+        vecIndex path = mbsp.get_path(1);
+        EWD_CHECK(path.size() == 4);
+        EWD_CHECK(find(path.begin(), path.end(), 3) != path.end());
+    }
+
+    // 几何边集合：(端点坐标, 权重)，与顶点、边编号无关
+    vector<vector<double>> segment_set(const GeometricGraph &g)
+    {
+        vector<vector<double>> ss;
+        for (EdgeIndex k = 0; k < g.num_edge(); k++)
+        {
+            Point a = g.vertex(g.edge(k).first), b = g.vertex(g.edge(k).second);
+            vector<double> s0 = {a.x, a.y, a.z}, s1 = {b.x, b.y, b.z};
+            if (s1 < s0)
+                swap(s0, s1);
+            s0.insert(s0.end(), s1.begin(), s1.end());
+            s0.push_back(g.weight(k));
+            ss.push_back(s0);
+        }
+        sort(ss.begin(), ss.end());
+        return ss;
+    }
+
+    // 批量打断与逐点打断得到相同的几何边；同一条边上的点乱序给出，端点上的点不打断
+    void test_break_edges(bool new_pnt)
+    {
+        GeometricGraph g;
+        g.add_vertex_simply(Point(0.0, 0.0, 0.0));
+        g.add_vertex_simply(Point(1000.0, 0.0, 0.0));
+        g.add_vertex_simply(Point(1000.0, 1000.0, 0.0));
+        g.add_vertex_simply(Point(0.0, 1000.0, 0.0));
+        for (size_t v = 0; v < 4; v++)
+            g.add_edge(v, (v + 1) % 4, 1000.0);
+        vector<Point> pnts = {Point(700.0, 0.0, 0.0), Point(1000.0, 400.0, 0.0), Point(200.0, 0.0, 0.0),
+                              Point(450.0, 0.0, 0.0), Point(0.0, 600.0, 0.0)};
+        vecIndex ks = {0, 1, 0, 0, 3};
+        if (!new_pnt)
+        {
+            pnts.push_back(Point(1000.0, 1000.0, 0.0));
+            ks.push_back(2);
+        }
+
+        // 逐点打断时先打断的边已被替换，按几何位置重新查找点所在的边；端点上的点不在任何边内部
+        GeometricGraph single = g;
+        for (size_t i = 0; i < pnts.size(); i++)
+        {
+            EdgeIndex k = 0;
+            while (k < single.num_edge() && !single.IsPntLieInEdge(pnts[i], k))
+                k++;
+            if (k == single.num_edge())
+                k = single.find_edge(g.edge(ks[i]).first, g.edge(ks[i]).second);
+            if (new_pnt)
+                single.BreakEdgeWithNewPnt(pnts[i], k);
+            else
+                single.BreakEdgeWithPnt(pnts[i], k);
+        }
+
+        GeometricGraph batch = g;
+        vecIndex edge_map;
+        vecIndex out = batch.BreakEdgesWithPnts(pnts, ks, new_pnt, &edge_map);
+        EWD_CHECK(segment_set(batch) == segment_set(single));
+        EWD_CHECK(batch.num_vertex() == single.num_vertex());
+        for (size_t i = 0; i < pnts.size(); i++)
+            EWD_CHECK(batch.vertex(out[i]).distance(pnts[i]) < 1e-9);
+        for (EdgeIndex k = 0; k < g.num_edge(); k++)
+        {
+            bool broken = find(ks.begin(), ks.end(), k) != ks.end() && (new_pnt || k != 2);
+            EWD_CHECK(broken == (edge_map[k] == numeric_limits<size_t>::max()));
+            if (!broken)
+                EWD_CHECK(batch.edge(edge_map[k]) == g.edge(k));
+        }
+        check_freeze(batch);
+    }
+
+    // 空间哈希查找与线性扫描一致：顶点与查询点落在格线两侧（含负坐标）时仍能找到，并取编号最小者
+    void test_find_vertex()
+    {
+        mt19937 rng(13);
+        uniform_int_distribution<int> cell(-3, 3);
+        uniform_real_distribution<double> offset(-0.6, 0.6);
+        GeometricGraph g;
+        g.set_ABS_ERR(0.5);
+        // 顶点紧贴格线（格宽为2*ABS_ERR）
+        for (size_t i = 0; i < 200; i++)
+            g.add_vertex_simply(Point(cell(rng) + offset(rng) * 0.01, cell(rng) + offset(rng) * 0.01, cell(rng) + offset(rng) * 0.01));
+        for (size_t i = 0; i < 500; i++)
+        {
+            Point v = g.vertex(i % g.num_vertex());
+            Point p(v.x + offset(rng), v.y + offset(rng), v.z + offset(rng));
+            size_t expected = g.num_vertex();
+            for (VertexIndex u = 0; u < g.num_vertex() && expected == g.num_vertex(); u++)
+            {
+                if (g.vertex(u).distance(p) < g.ABS_ERR())
+                    expected = u;
+            }
+            EWD_CHECK(g.find_vertex(p) == expected);
+        }
+
+        // add_vertex()合并跨格线的近邻点，只有超出误差的点才新建顶点
+        GeometricGraph h;
+        h.set_ABS_ERR(0.5);
+        VertexIndex a = h.add_vertex(Point(0.9999, -0.0001, 0.0));
+        EWD_CHECK(h.add_vertex(Point(1.0001, 0.0001, 0.0)) == a);
+        EWD_CHECK(h.add_vertex(Point(1.3, 0.2, -0.2)) == a);
+        EWD_CHECK(h.num_vertex() == 1);
+        EWD_CHECK(h.add_vertex(Point(1.6, 0.0, 0.0)) != a);
+        EWD_CHECK(h.num_vertex() == 2);
+    }
+}
+
+int main()
+{
+    test_freeze();
+    test_tombstones();
+    test_mark_removed_resolve();
+    test_break_edges(false);
+    test_break_edges(true);
+    test_find_vertex();
+    return EWD_TEST_RESULT();
+}
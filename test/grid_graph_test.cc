@@ -0,0 +1,64 @@
+#include "check.h"
+#include "scene.h"
+#include "graph_constructor.h"
+#include "decomposition_approach.h"
+
+using namespace std;
+using namespace ewd;
+
+// 由Hanan扫描直接建立的GridGraph与显式的GeometricGraph在边、最短路与求解结果上一致
+
+int main()
+{
+    GraphConstructor a;
+    ewd_test::add_floor(a);
+    ewd_test::add_circuit(a, ewd_test::circuit_a());
+    a.construct();
+    GeometricGraph &geo = a.g;
+
+    GraphConstructor b;
+    ewd_test::add_floor(b);
+    ewd_test::add_circuit(b, ewd_test::circuit_a());
+    b.preprocess();
+    GridGraph grid = b.build_grid_graph();
+
+    EWD_CHECK(grid.num_vertex() == geo.num_vertex());
+    EWD_CHECK(grid.num_edge() == geo.num_edge());
+    EWD_CHECK(b.PSB_index == a.PSB_index);
+    EWD_CHECK(b.devices_indices == a.devices_indices);
+    for (VertexIndex v = 0; v < geo.num_vertex(); v++)
+        EWD_CHECK(grid.vertex(v) == geo.vertex(v));
+    for (EdgeIndex k = 0; k < geo.num_edge(); k++)
+    {
+        EdgeIndex kg = grid.find_edge(geo.edge(k).first, geo.edge(k).second);
+        EWD_CHECK(kg < grid.num_edge());
+        if (kg < grid.num_edge())
+            EWD_CHECK_NEAR(grid.weight(kg), geo.weight(k), 1e-9);
+    }
+
+    // 两种图上的最少弯折最短路相同
+    const BendMode modes[] = {BendMode::PREDECESSOR_LISTS, BendMode::DIRECTION_STATES};
+    for (BendMode mode : modes)
+    {
+        MinBendShortestPath mg(geo), mh(grid);
+        mg.mode = mh.mode = mode;
+        mg.solve(a.PSB_index);
+        mh.solve(b.PSB_index);
+        for (VertexIndex v = 0; v < geo.num_vertex(); v++)
+        {
+            EWD_CHECK_NEAR(mh.distance(v), mg.distance(v), 1e-6);
+            EWD_CHECK(mh.num_bend(v) == mg.num_bend(v));
+        }
+    }
+
+    DecompositionApproach dg(geo), dh(grid);
+    dg.PSB = a.PSB_index;
+    dg.devices = a.devices_indices;
+    dh.PSB = b.PSB_index;
+    dh.devices = b.devices_indices;
+    dg.solve(true);
+    dh.solve(true);
+    EWD_CHECK(dh.obj == dg.obj);
+    EWD_CHECK(dh.paths == dg.paths);
+    return EWD_TEST_RESULT();
+}
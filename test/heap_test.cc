@@ -0,0 +1,78 @@
+#include "check.h"
+#include "algorithms/dary_heap.h"
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace ewd;
+
+// d叉索引堆与逐个扫描求最小值的结果比较
+
+namespace
+{
+    template <size_t D>
+    void test_random(unsigned seed)
+    {
+        const size_t n = 200;
+        mt19937 rng(seed);
+        uniform_int_distribution<size_t> pick(0, n - 1);
+        uniform_int_distribution<int> key(0, 50); // 取值范围小，相等的键较多
+        uniform_int_distribution<int> op(0, 3);
+
+        DaryHeap<int, D> h(n);
+        vector<int> keys(n, 0);
+        vector<char> in(n, 0), popped(n, 0);
+        size_t size = 0;
+        for (int step = 0; step < 5000; step++)
+        {
+            if (op(rng) > 0 || size == 0)
+            {
+                // 插入或修改键，增大与减小都有
+                size_t i = pick(rng);
+                if (popped[i])
+                    continue;
+                int k = key(rng);
+                size += !in[i];
+                h.update(i, k);
+                keys[i] = k;
+                in[i] = 1;
+            }
+            else
+            {
+                int best = numeric_limits<int>::max();
+                for (size_t i = 0; i < n; i++)
+                {
+                    if (in[i] && keys[i] < best)
+                        best = keys[i];
+                }
+                EWD_CHECK(h.top_key() == best);
+                size_t i = h.pop();
+                EWD_CHECK(in[i] && keys[i] == best);
+                in[i] = 0;
+                popped[i] = 1;
+                size--;
+            }
+            EWD_CHECK(h.size() == size);
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            EWD_CHECK(h.contains(i) == bool(in[i]));
+            if (in[i])
+                EWD_CHECK(h.key(i) == keys[i]);
+        }
+
+        // 重置后可复用
+        h.reset(n);
+        EWD_CHECK(h.empty());
+        for (size_t i = 0; i < n; i++)
+            EWD_CHECK(!h.contains(i));
+    }
+}
+
+int main()
+{
+    test_random<2>(1);
+    test_random<4>(2);
+    test_random<8>(3);
+    return EWD_TEST_RESULT();
+}
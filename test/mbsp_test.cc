@@ -0,0 +1,391 @@
+#include "check.h"
+#include "algorithms/mbsp.h"
+#include "algorithms/terminal_distances.h"
+#include <algorithm>
+#include <climits>
+#include <random>
+
+using namespace std;
+using namespace ewd;
+
+// 最少弯折最短路的各种求解方式与完整的单向Dijkstra比较
+
+namespace
+{
+    // nx×ny×nz网格，边权为边长乘1或2，代价相同的路径较多，弯折数决定取舍
+    GeometricGraph grid(size_t nx, size_t ny, size_t nz, unsigned seed)
+    {
+        mt19937 rng(seed);
+        uniform_int_distribution<int> factor(1, 2);
+        GeometricGraph g;
+        for (size_t k = 0; k < nz; k++)
+            for (size_t j = 0; j < ny; j++)
+                for (size_t i = 0; i < nx; i++)
+                    g.add_vertex_simply(Point(i * 100.0, j * 100.0, k * 100.0));
+        auto id = [&](size_t i, size_t j, size_t k) { return i + nx * (j + ny * k); };
+        for (size_t k = 0; k < nz; k++)
+            for (size_t j = 0; j < ny; j++)
+                for (size_t i = 0; i < nx; i++)
+                {
+                    if (i + 1 < nx)
+                        g.add_edge(id(i, j, k), id(i + 1, j, k), 100.0 * factor(rng));
+                    if (j + 1 < ny)
+                        g.add_edge(id(i, j, k), id(i, j + 1, k), 100.0 * factor(rng));
+                    if (k + 1 < nz)
+                        g.add_edge(id(i, j, k), id(i, j, k + 1), 100.0 * factor(rng));
+                }
+        return g;
+    }
+
+    double path_weight(const GeometricGraph &g, const vecIndex &path)
+    {
+        double w = 0.0;
+        for (size_t i = 0; i + 1 < path.size(); i++)
+        {
+            EdgeIndex k = g.find_edge(path[i], path[i + 1]);
+            EWD_CHECK(k < g.num_edge());
+            if (k < g.num_edge())
+                w += g.weight(k);
+        }
+        return w;
+    }
+
+    // 网格上的路径：相邻两段不同轴即为一次弯折
+    int path_bends(const GeometricGraph &g, const vecIndex &path)
+    {
+        int bends = 0;
+        for (size_t i = 1; i + 1 < path.size(); i++)
+        {
+            EdgeDirection a = direction_code(g.vertex(path[i]) - g.vertex(path[i - 1]));
+            EdgeDirection b = direction_code(g.vertex(path[i + 1]) - g.vertex(path[i]));
+            bends += !same_axis(a, b);
+        }
+        return bends;
+    }
+
+    struct Label
+    {
+        double dist;
+        int bends;
+    };
+
+    // 不用A*、求解全图的结果作为基准
+    vector<Label> reference(GeometricGraph &g, size_t root, BendMode mode)
+    {
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.use_astar = false;
+        mbsp.solve(root);
+        vector<Label> ls;
+        for (size_t v = 0; v < g.num_vertex(); v++)
+            ls.push_back(Label{mbsp.distance(v), mbsp.num_bend(v)});
+        return ls;
+    }
+
+    // 方向状态求得的弯折数是精确的最小值，代价与前继列表相同，弯折数不多于前继列表
+    void test_direction_states(GeometricGraph &g, size_t root)
+    {
+        vector<Label> lists = reference(g, root, BendMode::PREDECESSOR_LISTS);
+        vector<Label> states = reference(g, root, BendMode::DIRECTION_STATES);
+        for (size_t v = 0; v < g.num_vertex(); v++)
+        {
+            EWD_CHECK_NEAR(states[v].dist, lists[v].dist, 1e-6);
+            EWD_CHECK(states[v].bends <= lists[v].bends);
+        }
+    }
+
+    // 单起点单目标按A*求解，与不用A*的完整求解代价、弯折数相同
+    void test_astar(GeometricGraph &g, size_t root, BendMode mode)
+    {
+        vector<Label> ref = reference(g, root, mode);
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        for (size_t t = 0; t < g.num_vertex(); t++)
+        {
+            mbsp.solve(root, t);
+            EWD_CHECK_NEAR(mbsp.distance(t), ref[t].dist, 1e-6);
+            EWD_CHECK(mbsp.num_bend(t) == ref[t].bends);
+            EWD_CHECK_NEAR(path_weight(g, mbsp.get_path(t)), ref[t].dist, 1e-6);
+        }
+    }
+
+    // 双向求解与单向完整求解的代价、弯折数相同，路径从起点到终点
+    void test_bidirectional(GeometricGraph &g, size_t root)
+    {
+        vector<Label> ref = reference(g, root, BendMode::PREDECESSOR_LISTS);
+        MinBendShortestPath mbsp(g);
+        for (size_t t = 0; t < g.num_vertex(); t++)
+        {
+            mbsp.solve_bidirectional(root, t);
+            EWD_CHECK_NEAR(mbsp.distance(t), ref[t].dist, 1e-6);
+            EWD_CHECK(mbsp.num_bend(t) == ref[t].bends);
+            vecIndex path = mbsp.get_path(t);
+            if (t != root) // 起点没有前继，路径为空，与单向求解相同
+                EWD_CHECK(!path.empty() && path.front() == root && path.back() == t);
+            EWD_CHECK_NEAR(path_weight(g, path), ref[t].dist, 1e-6);
+            EWD_CHECK(path_bends(g, path) == ref[t].bends || t == root);
+        }
+    }
+
+    // 代价在精度的整数倍上时，压缩键可还原，其大小与CostBend的字典序一致；
+    // 按压缩键求解的代价与弯折数与原键相同
+    void test_packed_keys(GeometricGraph &g, size_t root, BendMode mode)
+    {
+        const double res = 0.5;
+        vector<CostBend> cbs;
+        for (int c = 0; c < 6; c++)
+            for (int b = -1; b < 3; b++)
+                cbs.push_back(CostBend(c * res, b, 1e-6));
+        for (const CostBend &x : cbs)
+        {
+            EWD_CHECK(unpack_cost_bend(pack_cost_bend(x, res), res) == x);
+            for (const CostBend &z : cbs)
+                EWD_CHECK((pack_cost_bend(x, res) < pack_cost_bend(z, res)) == (x < z));
+        }
+
+        vector<Label> ref = reference(g, root, mode);
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.use_astar = false;
+        mbsp.key_resolution = 1e-3;
+        mbsp.solve(root);
+        for (size_t v = 0; v < g.num_vertex(); v++)
+        {
+            EWD_CHECK_NEAR(mbsp.distance(v), ref[v].dist, 1e-6);
+            EWD_CHECK(mbsp.num_bend(v) == ref[v].bends);
+        }
+    }
+
+    // 同一求解器依次求解不同起点，复用的求解空间不残留上次的结果
+    void test_workspace_reuse(GeometricGraph &g, BendMode mode)
+    {
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.use_astar = false;
+        for (size_t root : {size_t(0), size_t(37), size_t(5), size_t(0)})
+        {
+            mbsp.solve(root, vecIndex{root + 1});
+            mbsp.solve(root);
+            vector<Label> ref = reference(g, root, mode);
+            for (size_t v = 0; v < g.num_vertex(); v++)
+            {
+                EWD_CHECK_NEAR(mbsp.distance(v), ref[v].dist, 1e-6);
+                EWD_CHECK(mbsp.num_bend(v) == ref[v].bends);
+            }
+        }
+    }
+
+    // 不可达的顶点：代价为无穷大，弯折数为int最大值
+    void test_unreachable(BendMode mode)
+    {
+        GeometricGraph g = grid(3, 3, 1, 1);
+        size_t island = g.add_vertex_simply(Point(1000.0, 1000.0, 0.0));
+        size_t far = g.add_vertex_simply(Point(1000.0, 1100.0, 0.0));
+        g.add_edge(island, far, 100.0);
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.solve(0);
+        for (size_t v : {island, far})
+        {
+            EWD_CHECK(mbsp.distance(v) == numeric_limits<double>::infinity());
+            EWD_CHECK(mbsp.num_bend(v) == INT_MAX);
+            EWD_CHECK(mbsp.get_path(v).empty());
+        }
+        mbsp.solve(0, far);
+        EWD_CHECK(mbsp.distance(far) == numeric_limits<double>::infinity());
+        EWD_CHECK(mbsp.num_bend(far) == INT_MAX);
+        if (mode == BendMode::PREDECESSOR_LISTS)
+        {
+            mbsp.solve_bidirectional(0, far);
+            EWD_CHECK(mbsp.distance(far) == numeric_limits<double>::infinity());
+            EWD_CHECK(mbsp.num_bend(far) == INT_MAX);
+        }
+    }
+
+    // 多起点求解：各顶点的代价为到最近起点的距离，区域边界边两侧的路径相连后，
+    // 长度与弯折数与num_bend_through()一致
+    void test_multi_source(GeometricGraph &g, BendMode mode)
+    {
+        vecIndex roots = {0, 9, 37, 52, g.num_vertex() - 1};
+        vector<vector<Label>> refs;
+        for (size_t r : roots)
+            refs.push_back(reference(g, r, mode));
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.solve_multi_source(roots);
+        for (size_t v = 0; v < g.num_vertex(); v++)
+        {
+            double d = numeric_limits<double>::infinity();
+            for (auto &ref : refs)
+                d = min(d, ref[v].dist);
+            EWD_CHECK_NEAR(mbsp.distance(v), d, 1e-6);
+            size_t s = mbsp.source(v);
+            size_t i = find(roots.begin(), roots.end(), s) - roots.begin();
+            EWD_CHECK(i < roots.size());
+            if (i < roots.size())
+                EWD_CHECK_NEAR(refs[i][v].dist, mbsp.distance(v), 1e-6);
+        }
+        for (EdgeIndex k = 0; k < g.num_edge(); k++)
+        {
+            Edge e = g.edge(k);
+            if (mbsp.source(e.first) == mbsp.source(e.second))
+                continue;
+            vecIndex path = mbsp.path_through(e.first, e.second);
+            EWD_CHECK(!path.empty() && path.front() == mbsp.source(e.first) && path.back() == mbsp.source(e.second));
+            EWD_CHECK_NEAR(path_weight(g, path), mbsp.distance(e.first) + g.weight(k) + mbsp.distance(e.second), 1e-6);
+            EWD_CHECK(path_bends(g, path) == mbsp.num_bend_through(e.first, e.second));
+        }
+    }
+
+    // 增量生长：每一步返回的目标与以当前树的所有顶点为起点重新求解的结果相同
+    void test_grow_sources(GeometricGraph &g, BendMode mode)
+    {
+        vecIndex targets = {5, 23, 40, 61, 88, g.num_vertex() - 1};
+        vecIndex tree = {37};
+        MinBendShortestPath warm(g), cold(g);
+        warm.mode = cold.mode = mode;
+        vecIndex left = targets;
+        for (size_t t = warm.solve_nearest(tree, targets); t != numeric_limits<size_t>::max();)
+        {
+            auto it = find(left.begin(), left.end(), t);
+            EWD_CHECK(it != left.end());
+            if (it == left.end())
+                break;
+            left.erase(it);
+
+            cold.solve_multi_source(tree);
+            double nearest = numeric_limits<double>::infinity();
+            for (size_t u : left)
+                nearest = min(nearest, cold.distance(u));
+            EWD_CHECK_NEAR(warm.distance(t), cold.distance(t), 1e-6);
+            EWD_CHECK(warm.num_bend(t) == cold.num_bend(t));
+            EWD_CHECK(warm.distance(t) <= nearest + 1e-6);
+
+            vecIndex path;
+            EWD_CHECK(warm.get_path(t, path));
+            EWD_CHECK(find(tree.begin(), tree.end(), path.front()) != tree.end());
+            EWD_CHECK_NEAR(path_weight(g, path), warm.distance(t), 1e-6);
+            tree.insert(tree.end(), path.begin(), path.end());
+            t = warm.grow_sources(path);
+        }
+        EWD_CHECK(left.empty());
+    }
+
+    // 所有目标确定后即停止的求解，目标的代价、弯折数与路径与求解全图相同
+    void test_targets(GeometricGraph &g, size_t root, BendMode mode)
+    {
+        MinBendShortestPath full(g), part(g);
+        full.mode = part.mode = mode;
+        full.use_astar = part.use_astar = false;
+        full.solve(root);
+        vecIndex targets = {3, 17, g.num_vertex() - 1};
+        part.solve(root, targets);
+        for (size_t t : targets)
+        {
+            EWD_CHECK_NEAR(part.distance(t), full.distance(t), 1e-6);
+            EWD_CHECK(part.num_bend(t) == full.num_bend(t));
+            EWD_CHECK(part.get_path(t) == full.get_path(t));
+        }
+    }
+
+    // 多线程求得的终端距离矩阵与单线程、逐个起点求解的结果相同，保存的树可提取等长的路径
+    // 只剩一个目标时按A*求解，代价相同的路径可能与完整求解不同
+    void test_terminal_distances(GeometricGraph &g, BendMode mode)
+    {
+        vecIndex terminals = {0, 9, 37, 52, g.num_vertex() - 1};
+        size_t N = terminals.size();
+        MinBendShortestPath one(g), many(g);
+        one.mode = many.mode = mode;
+        PathTreeStore trees;
+        vector<CostBend> d1 = terminal_distances(one, terminals, 1e-2, 1);
+        vector<CostBend> dn = terminal_distances(many, terminals, 1e-2, 4, &trees);
+        EWD_CHECK(d1.size() == N * N && dn.size() == N * N);
+
+        MinBendShortestPath ref(g);
+        ref.mode = mode;
+        for (size_t i = 0; i < N; i++)
+        {
+            ref.solve(terminals[i]);
+            const PathTree *tree = trees.find(terminals[i]);
+            for (size_t j = 0; j < N; j++)
+            {
+                const CostBend &a = d1[i * N + j], &b = dn[i * N + j];
+                EWD_CHECK(a.first == b.first && a.second == b.second);
+                EWD_CHECK(a == dn[j * N + i]);
+                if (i == j)
+                {
+                    EWD_CHECK(a.first == 0.0);
+                    continue;
+                }
+                if (j < i)
+                    continue;
+                EWD_CHECK_NEAR(a.first, ref.distance(terminals[j]), 1e-6);
+                EWD_CHECK(a.second == ref.num_bend(terminals[j]));
+                vecIndex saved;
+                EWD_CHECK(tree != nullptr && many.get_path(*tree, terminals[j], saved));
+                EWD_CHECK(!saved.empty() && saved.front() == terminals[i] && saved.back() == terminals[j]);
+                EWD_CHECK_NEAR(path_weight(g, saved), a.first, 1e-6);
+            }
+        }
+    }
+
+    // 保存的最短路树与求解后直接提取的路径相同
+    void test_path_tree(GeometricGraph &g, size_t root, BendMode mode)
+    {
+        MinBendShortestPath mbsp(g);
+        mbsp.mode = mode;
+        mbsp.solve(root);
+        PathTree tree = mbsp.export_tree();
+        EWD_CHECK(!tree.empty() && tree.root == root);
+        for (size_t v = 0; v < g.num_vertex(); v++)
+        {
+            vecIndex direct, saved;
+            bool ok = mbsp.get_path(v, direct);
+            EWD_CHECK(mbsp.get_path(tree, v, saved) == ok);
+            EWD_CHECK(saved == direct);
+        }
+
+        // 只求到部分目标时，树只含已确定的顶点
+        vecIndex targets = {1, g.num_vertex() / 2};
+        mbsp.solve(root, targets);
+        tree = mbsp.export_tree();
+        EWD_CHECK(tree.vertices.size() < g.num_vertex());
+        for (size_t t : targets)
+        {
+            vecIndex direct, saved;
+            EWD_CHECK(mbsp.get_path(t, direct));
+            EWD_CHECK(mbsp.get_path(tree, t, saved));
+            EWD_CHECK(saved == direct);
+        }
+    }
+}
+
+int main()
+{
+    GeometricGraph g = grid(6, 5, 3, 3);
+    const BendMode modes[] = {BendMode::PREDECESSOR_LISTS, BendMode::DIRECTION_STATES};
+    for (BendMode mode : modes)
+    {
+        test_workspace_reuse(g, mode);
+        test_unreachable(mode);
+        test_terminal_distances(g, mode);
+        test_multi_source(g, mode);
+        test_grow_sources(g, mode);
+    }
+    for (size_t root : {size_t(0), size_t(37)})
+    {
+        test_direction_states(g, root);
+        for (BendMode mode : modes)
+        {
+            test_astar(g, root, mode);
+            test_packed_keys(g, root, mode);
+        }
+        test_bidirectional(g, root);
+        for (BendMode mode : modes)
+        {
+            test_targets(g, root, mode);
+            test_path_tree(g, root, mode);
+        }
+    }
+    return EWD_TEST_RESULT();
+}
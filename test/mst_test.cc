@@ -0,0 +1,124 @@
+#include "check.h"
+#include "algorithms/mst.h"
+#include <algorithm>
+#include <random>
+
+using namespace std;
+using namespace ewd;
+
+// 完全图上的DensePrim、稀疏图上的Kruskal与堆上的Prim给出相同的最小生成树（森林），
+// 按疏密选择的MinimumSpanningTree与两者一致
+
+namespace
+{
+    const double INF = numeric_limits<double>::infinity();
+
+    vector<pair<size_t, size_t>> normalized(vector<pair<size_t, size_t>> es)
+    {
+        for (auto &e : es)
+        {
+            if (e.first > e.second)
+                swap(e.first, e.second);
+        }
+        sort(es.begin(), es.end());
+        return es;
+    }
+
+    vector<pair<size_t, size_t>> endpoints(const Graph &g, const vecIndex &ks)
+    {
+        vector<pair<size_t, size_t>> es;
+        for (EdgeIndex k : ks)
+            es.push_back(g.edge(k));
+        return normalized(es);
+    }
+
+    // 权重互不相同时最小生成树唯一；num_parts > 1时顶点按编号分组，组间不连通
+    void test_complete(size_t N, size_t num_parts, unsigned seed)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<double> w(1.0, 100.0);
+        vector<CostBend> dist(N * N, CostBend(INF, 0));
+        Graph g;
+        g.set_vertex_num(N);
+        vector<pair<size_t, size_t>> edges;
+        vector<CostBend> weights;
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (i % num_parts != j % num_parts)
+                    continue;
+                CostBend c(w(rng), 0, 1e-9);
+                dist[i * N + j] = dist[j * N + i] = c;
+                g.add_edge(i, j, c.first);
+                edges.push_back(make_pair(i, j));
+                weights.push_back(c);
+            }
+        }
+
+        vector<pair<size_t, size_t>> dense = normalized(DensePrimMinimumSpanningTree(dist, N));
+        EWD_CHECK(dense.size() == N - num_parts);
+
+        vector<pair<size_t, size_t>> kruskal;
+        for (size_t k : KruskalMinimumSpanningTree(N, edges, weights))
+            kruskal.push_back(edges[k]);
+        EWD_CHECK(normalized(kruskal) == dense);
+
+        CsrGraph csr = g.freeze();
+        EWD_CHECK(endpoints(g, PrimMinimumSpanningTree<DaryHeap<CostBend>>(csr, weights, 1e-9)) == dense);
+        EWD_CHECK(endpoints(g, PrimMinimumSpanningTree(g, weights, 1e-9)) == dense);
+        EWD_CHECK(normalized(MinimumSpanningTree(dist, N)) == dense);
+    }
+
+    // 网格上的整数权重有大量相等的边，只比较树的总权重
+    void test_grid(size_t side, unsigned seed)
+    {
+        mt19937 rng(seed);
+        uniform_int_distribution<int> w(1, 3);
+        Graph g;
+        g.set_vertex_num(side * side);
+        vector<pair<size_t, size_t>> edges;
+        vector<CostBend> weights;
+        for (size_t r = 0; r < side; r++)
+        {
+            for (size_t c = 0; c < side; c++)
+            {
+                size_t v = r * side + c;
+                for (size_t u : {c + 1 < side ? v + 1 : v, r + 1 < side ? v + side : v})
+                {
+                    if (u == v)
+                        continue;
+                    CostBend cb(w(rng), 0, 1e-9);
+                    g.add_edge(v, u, cb.first);
+                    edges.push_back(make_pair(v, u));
+                    weights.push_back(cb);
+                }
+            }
+        }
+        size_t N = g.num_vertex();
+        vector<CostBend> dist(N * N, CostBend(INF, 0));
+        for (size_t k = 0; k < edges.size(); k++)
+            dist[edges[k].first * N + edges[k].second] = dist[edges[k].second * N + edges[k].first] = weights[k];
+        CsrGraph csr = g.freeze();
+        vecIndex kruskal = KruskalMinimumSpanningTree(g.num_vertex(), edges, weights);
+        vecIndex prim = PrimMinimumSpanningTree<DaryHeap<CostBend>>(csr, weights, 1e-9);
+        EWD_CHECK(kruskal.size() == g.num_vertex() - 1);
+        EWD_CHECK(prim.size() == kruskal.size());
+        EWD_CHECK_NEAR(g.total_weight(prim), g.total_weight(kruskal), 1e-9);
+        double total = 0;
+        vector<pair<size_t, size_t>> tree = MinimumSpanningTree(dist, N);
+        for (auto &e : tree)
+            total += dist[e.first * N + e.second].first;
+        EWD_CHECK(tree.size() == kruskal.size());
+        EWD_CHECK_NEAR(total, g.total_weight(kruskal), 1e-9);
+    }
+}
+
+int main()
+{
+    test_complete(12, 1, 5);
+    test_complete(12, 2, 7);
+    test_complete(12, 3, 6);
+    test_grid(8, 9);
+    return EWD_TEST_RESULT();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "graph_constructor.h"
+#include <vector>
+
+// 测试用的楼层：两个房间，中间墙上有门，外墙上有窗，左侧房间有一根梁
+
+namespace ewd_test
+{
+    template <typename Floor>
+    void add_floor(Floor &f)
+    {
+        using ewd::BarrierType;
+        using ewd::Point;
+        using ewd::Wall;
+        using ewd::Door;
+        double H = 3300, T = 200;
+        f.add_wall(Wall("w1", "w1", Point(0, 0, 0), Point(6000, 0, 0), H, T));
+        f.add_wall(Wall("w2", "w2", Point(6000, 0, 0), Point(6000, 4000, 0), H, T));
+        f.add_wall(Wall("w3", "w3", Point(6000, 4000, 0), Point(0, 4000, 0), H, T));
+        f.add_wall(Wall("w4", "w4", Point(0, 4000, 0), Point(0, 0, 0), H, T));
+        f.add_wall(Wall("w5", "w5", Point(3000, 0, 0), Point(3000, 4000, 0), H, T));
+        f.add_door(Door("d1", "d1", Point(3000, 1500, 0), Point(3000, 2500, 0), 2100, T, "w5", BarrierType::DOOR));
+        f.add_door(Door("n1", "n1", Point(4000, 4000, 900), Point(5000, 4000, 900), 1500, T, "w3", BarrierType::WINDOW));
+        f.add_wall(Wall("b1", "b1", Point(1500, 0, 2900), Point(1500, 4000, 2900), 400, T, BarrierType::BEAM));
+        f.set_PSB(ewd::Device("psb", "PSB", Point(500, 120, 1500), "w1", "r1"));
+    }
+
+    // 接线盒在吊顶上，插座在吊顶下
+    inline std::vector<ewd::Device> circuit_a()
+    {
+        using ewd::Device;
+        using ewd::Point;
+        return {Device("a", "Junction Box", Point(1000, 3300, 3300), "", "r1"),
+                Device("b", "Socket", Point(4500, 120, 300), "w1", "r2"),
+                Device("c", "Socket", Point(4600, 120, 300), "w1", "r2"),
+                Device("d", "Socket", Point(5880, 2000, 1300), "w2", "r2")};
+    }
+
+    inline std::vector<ewd::Device> circuit_b()
+    {
+        using ewd::Device;
+        using ewd::Point;
+        return {Device("e", "Junction Box", Point(2200, 1000, 3300), "", "r1"),
+                Device("f", "Socket", Point(120, 2500, 300), "w4", "r1"),
+                Device("g", "Light", Point(800, 3000, 3300), "", "r1"),
+                Device("h", "Socket", Point(2880, 800, 300), "w5", "r1"),
+                Device("i", "Socket", Point(3120, 3500, 1300), "w5", "r2")};
+    }
+
+    template <typename Floor>
+    void add_circuit(Floor &f, const std::vector<ewd::Device> &devices)
+    {
+        for (const ewd::Device &dev : devices)
+            f.add_device(dev);
+    }
+}
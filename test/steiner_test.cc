@@ -0,0 +1,112 @@
+#include "check.h"
+#include "algorithms/steiner_tree.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace std;
+using namespace ewd;
+
+// 小图上Dreyfus–Wagner的结果与枚举所有边子集得到的Steiner最小树比较
+
+namespace
+{
+    const double INF = numeric_limits<double>::infinity();
+
+    size_t find_root(vecIndex &parent, size_t v)
+    {
+        while (parent[v] != v)
+            v = parent[v] = parent[parent[v]];
+        return v;
+    }
+
+    // 边子集ks是否连通所有终端
+    bool spans(const Graph &g, const vecIndex &ks, const vecIndex &terminals)
+    {
+        vecIndex parent(g.num_vertex());
+        iota(parent.begin(), parent.end(), size_t(0));
+        for (EdgeIndex k : ks)
+            parent[find_root(parent, g.edge(k).first)] = find_root(parent, g.edge(k).second);
+        for (size_t t : terminals)
+        {
+            if (find_root(parent, t) != find_root(parent, terminals[0]))
+                return false;
+        }
+        return true;
+    }
+
+    double brute_force(const Graph &g, const vecIndex &terminals)
+    {
+        double best = INF;
+        for (size_t mask = 0; mask < (size_t(1) << g.num_edge()); mask++)
+        {
+            vecIndex ks;
+            for (EdgeIndex k = 0; k < g.num_edge(); k++)
+            {
+                if (mask >> k & 1)
+                    ks.push_back(k);
+            }
+            double w = g.total_weight(ks);
+            if (w < best && spans(g, ks, terminals))
+                best = w;
+        }
+        return best;
+    }
+
+    void test_random(size_t n, size_t m, size_t k, unsigned seed)
+    {
+        mt19937 rng(seed);
+        uniform_int_distribution<size_t> pick(0, n - 1);
+        uniform_int_distribution<int> w(1, 9);
+        Graph g;
+        g.set_vertex_num(n);
+        while (g.num_edge() < m)
+        {
+            size_t a = pick(rng), b = pick(rng);
+            if (a != b)
+                g.add_edge(a, b, w(rng));
+        }
+        vecIndex order(n);
+        iota(order.begin(), order.end(), size_t(0));
+        shuffle(order.begin(), order.end(), rng);
+        vecIndex terminals(order.begin(), order.begin() + k);
+
+        double expected = brute_force(g, terminals);
+        SteinerTree tree = DreyfusWagnerSteinerTree(g.freeze(), terminals, 10, 2);
+        if (expected == INF)
+        {
+            EWD_CHECK(tree.empty());
+            return;
+        }
+        EWD_CHECK_NEAR(tree.cost, expected, 1e-9);
+        EWD_CHECK_NEAR(g.total_weight(tree.edges), tree.cost, 1e-9);
+        EWD_CHECK(spans(g, tree.edges, terminals));
+        EWD_CHECK(is_sorted(tree.edges.begin(), tree.edges.end()));
+    }
+
+    void test_limits()
+    {
+        Graph g;
+        g.set_vertex_num(4);
+        g.add_edge(0, 1, 1.0);
+        g.add_edge(1, 2, 1.0);
+        g.add_edge(2, 3, 1.0);
+        vecIndex terminals = {0, 2, 3};
+        EWD_CHECK(DreyfusWagnerMemory(4, 3) == 3 * 4 * (sizeof(double) + sizeof(uint32_t)));
+        EWD_CHECK(!DreyfusWagnerSteinerTree(g.freeze(), terminals).empty());
+        EWD_CHECK(DreyfusWagnerSteinerTree(g.freeze(), terminals, 2).empty());
+        EWD_CHECK(DreyfusWagnerSteinerTree(g.freeze(), terminals, 10, 1, DreyfusWagnerMemory(4, 3) - 1).empty());
+    }
+}
+
+int main()
+{
+    unsigned seed = 1;
+    for (size_t k = 2; k <= 5; k++)
+    {
+        for (int rep = 0; rep < 4; rep++)
+            test_random(9, 15, k, seed++);
+    }
+    test_limits();
+    return EWD_TEST_RESULT();
+}